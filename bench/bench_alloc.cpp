@@ -0,0 +1,44 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "bench_alloc.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<long long> count( 0 );
+
+} // namespace
+
+long long wup_bench::allocations() noexcept
+{
+    return count.load( std::memory_order_relaxed );
+}
+
+// the other forms of operator new and delete call these
+
+void * operator new( std::size_t n )
+{
+    count.fetch_add( 1, std::memory_order_relaxed );
+
+    if( void * p = std::malloc( n ? n : 1 ) )
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void * p ) noexcept
+{
+    std::free( p );
+}
+
+void operator delete( void * p, std::size_t ) noexcept
+{
+    std::free( p );
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef WUP_BENCH_ALLOC_HPP_INCLUDED
+#define WUP_BENCH_ALLOC_HPP_INCLUDED
+
+// The calls of operator new, counted by the replacement in bench_alloc.cpp.
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+namespace wup_bench {
+
+long long allocations() noexcept;
+
+// Reports the allocations per iteration since before, and the size of a
+// handle, with the time of the benchmark.
+inline void report( benchmark::State & state, long long before, std::size_t handle_size )
+{
+    state.counters[ "allocs/op" ] = benchmark::Counter( static_cast<double>( allocations() - before ), benchmark::Counter::kAvgIterations );
+    state.counters[ "bytes/handle" ] = benchmark::Counter( static_cast<double>( handle_size ), benchmark::Counter::kAvgThreads );
+}
+
+// into a register, so that the work is not optimized away
+template<class T> inline void keep( T const & v )
+{
+    benchmark::DoNotOptimize( v );
+}
+
+} // namespace wup_bench
+
+#endif // #ifndef WUP_BENCH_ALLOC_HPP_INCLUDED
@@ -0,0 +1,675 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// weakable_unique_ptr and unique_weak_ptr against std::unique_ptr, and
+// against shared_ptr and weak_ptr from boost and std: the owners, the
+// observers, and reads through the observers from one or more threads.
+
+#include "weakable_unique_ptr.hpp"
+#include "bench_alloc.hpp"
+#include <boost/smart_ptr/make_shared.hpp>
+#include <boost/smart_ptr/shared_ptr.hpp>
+#include <boost/smart_ptr/weak_ptr.hpp>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+using wup_bench::keep;
+using wup_bench::report;
+
+namespace {
+
+struct X
+{
+    long v = 1;
+};
+
+// the object is read through an observer the way each kind has to,
+// a weak_ptr with lock()
+
+struct weakable
+{
+    typedef boost::weakable_unique_ptr<X> owner;
+    typedef boost::unique_weak_ptr<X> observer;
+
+    static owner make() { return owner( new X ); }
+    static boost::weakable_unique_ptr<X, boost::weakable_inplace_deleter> make_fused() { return boost::make_weakable_unique<X>(); }
+    static observer observe( owner const & o ) { return observer( o ); }
+
+    static long read( observer const & w )
+    {
+        X * p = w.try_get();
+        return p? p->v: 0;
+    }
+};
+
+struct weakable_mt
+{
+    typedef boost::weakable_multi_threaded policy;
+    typedef boost::weakable_unique_ptr<X, std::default_delete<X>, policy> owner;
+    typedef boost::unique_weak_ptr<X, policy> observer;
+
+    static owner make() { return owner( new X ); }
+    static boost::weakable_unique_ptr<X, boost::weakable_inplace_deleter, policy> make_fused() { return boost::make_weakable_unique<X, policy>(); }
+    static observer observe( owner const & o ) { return observer( o ); }
+
+    static long read( observer const & w )
+    {
+        auto l = w.lock();
+        return l? l->v: 0;
+    }
+};
+
+// the block is allocated with the owner, which holds only the block
+struct weakable_compact
+{
+    typedef boost::weakable_compact<> policy;
+    typedef boost::weakable_unique_ptr<X, std::default_delete<X>, policy> owner;
+    typedef boost::unique_weak_ptr<X, policy> observer;
+
+    static owner make() { return owner( new X ); }
+    static boost::weakable_unique_ptr<X, boost::weakable_inplace_deleter, policy> make_fused() { return boost::make_weakable_unique<X, policy>(); }
+    static observer observe( owner const & o ) { return observer( o ); }
+
+    static long read( observer const & w )
+    {
+        X * p = w.try_get();
+        return p? p->v: 0;
+    }
+};
+
+// blocks on cache lines of their own
+struct weakable_ca
+{
+    typedef boost::weakable_cache_aligned policy;
+    typedef boost::weakable_unique_ptr<X, std::default_delete<X>, policy> owner;
+    typedef boost::unique_weak_ptr<X, policy> observer;
+
+    static owner make() { return owner( new X ); }
+    static boost::weakable_unique_ptr<X, boost::weakable_inplace_deleter, policy> make_fused() { return boost::make_weakable_unique<X, policy>(); }
+    static observer observe( owner const & o ) { return observer( o ); }
+
+    static long read( observer const & w )
+    {
+        auto l = w.lock();
+        return l? l->v: 0;
+    }
+};
+
+struct std_shared
+{
+    typedef std::shared_ptr<X> owner;
+    typedef std::weak_ptr<X> observer;
+
+    static owner make() { return owner( new X ); }
+    static owner make_fused() { return std::make_shared<X>(); }
+    static observer observe( owner const & o ) { return observer( o ); }
+
+    static long read( observer const & w )
+    {
+        owner l = w.lock();
+        return l? l->v: 0;
+    }
+};
+
+struct boost_shared
+{
+    typedef boost::shared_ptr<X> owner;
+    typedef boost::weak_ptr<X> observer;
+
+    static owner make() { return owner( new X ); }
+    static owner make_fused() { return boost::make_shared<X>(); }
+    static observer observe( owner const & o ) { return observer( o ); }
+
+    static long read( observer const & w )
+    {
+        owner l = w.lock();
+        return l? l->v: 0;
+    }
+};
+
+// owners only
+struct std_unique
+{
+    typedef std::unique_ptr<X> owner;
+
+    static owner make() { return owner( new X ); }
+    static owner make_fused() { return owner( new X ); }
+};
+
+// owners
+
+template<class F> void construct_destroy( benchmark::State & state )
+{
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        typename F::owner p = F::make();
+        keep( p.get() );
+    }
+
+    report( state, a, sizeof( typename F::owner ) );
+}
+
+template<class F> void make_destroy( benchmark::State & state )
+{
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        auto p = F::make_fused();
+        keep( p.get() );
+    }
+
+    report( state, a, sizeof( F::make_fused() ) );
+}
+
+template<class F> void move_owner( benchmark::State & state )
+{
+    typename F::owner p = F::make();
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        typename F::owner q( std::move( p ) );
+        p = std::move( q );
+        keep( p.get() );
+    }
+
+    report( state, a, sizeof( typename F::owner ) );
+}
+
+template<class F> void reset_owner( benchmark::State & state )
+{
+    typename F::owner p = F::make();
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        p.reset( new X );
+        keep( p.get() );
+    }
+
+    report( state, a, sizeof( typename F::owner ) );
+}
+
+// an owner and its first observer: the lazy layout allocates the block
+// here, the eager one with the owner
+template<class F> void construct_observe( benchmark::State & state )
+{
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        typename F::owner p = F::make();
+        typename F::observer w = F::observe( p );
+        keep( w );
+    }
+
+    report( state, a, sizeof( typename F::owner ) );
+}
+
+// a pass over a container of owners through operator->, the compact
+// layout loads the pointer from the block of each owner
+template<class F> void deref_scan( benchmark::State & state )
+{
+    std::size_t n = static_cast<std::size_t>( state.range( 0 ) );
+
+    std::vector<typename F::owner> owners;
+
+    for( std::size_t i = 0; i < n; ++i )
+    {
+        owners.push_back( F::make() );
+    }
+
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        long s = 0;
+
+        for( auto const & p: owners )
+        {
+            s += p->v;
+        }
+
+        keep( s );
+    }
+
+    state.SetItemsProcessed( state.iterations() * static_cast<long long>( n ) );
+    report( state, a, sizeof( typename F::owner ) );
+}
+
+template<class F> void deref_scan_fused( benchmark::State & state )
+{
+    std::size_t n = static_cast<std::size_t>( state.range( 0 ) );
+
+    std::vector<decltype( F::make_fused() )> owners;
+
+    for( std::size_t i = 0; i < n; ++i )
+    {
+        owners.push_back( F::make_fused() );
+    }
+
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        long s = 0;
+
+        for( auto const & p: owners )
+        {
+            s += p->v;
+        }
+
+        keep( s );
+    }
+
+    state.SetItemsProcessed( state.iterations() * static_cast<long long>( n ) );
+    report( state, a, sizeof( F::make_fused() ) );
+}
+
+// an observed owner handed to a shared_ptr: converted, so that the
+// observers keep seeing the object; released into a new shared_ptr,
+// which expires them; or the owner itself kept by make_shared
+template<class S> void to_shared_convert( benchmark::State & state )
+{
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        weakable::owner p = weakable::make();
+        weakable::observer w = weakable::observe( p );
+
+        S s = std::move( p );
+        keep( s.get() );
+        keep( w );
+    }
+
+    report( state, a, sizeof( S ) );
+}
+
+template<class S> void to_shared_release( benchmark::State & state )
+{
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        weakable::owner p = weakable::make();
+        weakable::observer w = weakable::observe( p );
+
+        S s( p.release() );
+        keep( s.get() );
+        keep( w );
+    }
+
+    report( state, a, sizeof( S ) );
+}
+
+template<class S> void to_shared_wrap( benchmark::State & state )
+{
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        weakable::owner p = weakable::make();
+        weakable::observer w = weakable::observe( p );
+
+        auto s = S::make( std::move( p ) );
+        keep( s.get() );
+        keep( w );
+    }
+
+    report( state, a, sizeof( decltype( S::make( weakable::make() ) ) ) );
+}
+
+struct std_wrap
+{
+    static std::shared_ptr<weakable::owner> make( weakable::owner && p ) { return std::make_shared<weakable::owner>( std::move( p ) ); }
+};
+
+struct boost_wrap
+{
+    static boost::shared_ptr<weakable::owner> make( weakable::owner && p ) { return boost::make_shared<weakable::owner>( std::move( p ) ); }
+};
+
+// the assignments and reset() of an owner that holds nothing, the
+// cost of the owner without that of the allocator
+template<class F> void reset_empty( benchmark::State & state )
+{
+    typename F::owner p;
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        p.reset();
+        keep( p.get() );
+    }
+
+    report( state, a, sizeof( typename F::owner ) );
+}
+
+template<class F> void assign_empty( benchmark::State & state )
+{
+    typename F::owner p, q;
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        p = std::move( q );
+        q = nullptr;
+        keep( p.get() );
+    }
+
+    report( state, a, sizeof( typename F::owner ) );
+}
+
+// observers
+
+template<class F> void observe( benchmark::State & state )
+{
+    typename F::owner p = F::make();
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        typename F::observer w = F::observe( p );
+        keep( w );
+    }
+
+    report( state, a, sizeof( typename F::observer ) );
+}
+
+template<class F> void copy_observer( benchmark::State & state )
+{
+    typename F::owner p = F::make();
+    typename F::observer w = F::observe( p );
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        typename F::observer c( w );
+        keep( c );
+    }
+
+    report( state, a, sizeof( typename F::observer ) );
+}
+
+template<class F> void read( benchmark::State & state, bool live )
+{
+    typename F::owner p = F::make();
+    typename F::observer w = F::observe( p );
+
+    if( !live )
+    {
+        p.reset();
+    }
+
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        keep( F::read( w ) );
+    }
+
+    report( state, a, sizeof( typename F::observer ) );
+}
+
+template<class F> void read_live( benchmark::State & state )
+{
+    read<F>( state, true );
+}
+
+template<class F> void read_dead( benchmark::State & state )
+{
+    read<F>( state, false );
+}
+
+template<class F> void expired( benchmark::State & state, bool live )
+{
+    typename F::owner p = F::make();
+    typename F::observer w = F::observe( p );
+
+    if( !live )
+    {
+        p.reset();
+    }
+
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        keep( w.expired() );
+    }
+
+    report( state, a, sizeof( typename F::observer ) );
+}
+
+template<class F> void expired_live( benchmark::State & state )
+{
+    expired<F>( state, true );
+}
+
+template<class F> void expired_dead( benchmark::State & state )
+{
+    expired<F>( state, false );
+}
+
+// a registry of observers, every other object dead, read in one pass
+template<class F> void scan( benchmark::State & state )
+{
+    std::size_t n = static_cast<std::size_t>( state.range( 0 ) );
+
+    std::vector<typename F::owner> owners;
+    std::vector<typename F::observer> observers;
+
+    for( std::size_t i = 0; i < n; ++i )
+    {
+        owners.push_back( F::make() );
+        observers.push_back( F::observe( owners.back() ) );
+    }
+
+    for( std::size_t i = 0; i < n; i += 2 )
+    {
+        owners[ i ].reset();
+    }
+
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        long s = 0;
+
+        for( auto const & w: observers )
+        {
+            s += F::read( w );
+        }
+
+        keep( s );
+    }
+
+    state.SetItemsProcessed( state.iterations() * static_cast<long long>( n ) );
+    report( state, a, sizeof( typename F::observer ) );
+}
+
+// threads read one object, each through its own observer
+template<class F> void read_shared( benchmark::State & state )
+{
+    static typename F::owner p = F::make();
+    static typename F::observer w0 = F::observe( p );
+
+    typename F::observer w( w0 );
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        keep( F::read( w ) );
+    }
+
+    report( state, a, sizeof( typename F::observer ) );
+}
+
+// threads check one object with try_get(), each through its own
+// observer, while their observers count in the same block
+template<class F> void try_get_shared( benchmark::State & state )
+{
+    static typename F::owner p = F::make();
+    static typename F::observer w0 = F::observe( p );
+
+    typename F::observer w( w0 );
+    long long a = wup_bench::allocations();
+
+    for( auto _: state )
+    {
+        keep( w.try_get() );
+        typename F::observer c( w );
+        keep( c );
+    }
+
+    report( state, a, sizeof( typename F::observer ) );
+}
+
+// n owners destroyed in one call of weakable_destroy_all, or one by
+// one, each observed or not; the objects are made outside of the timing
+template<class F> void make_owners( std::vector<typename F::owner> & v, std::vector<typename F::observer> & w, std::size_t n, bool observed )
+{
+    v.clear();
+    w.clear();
+
+    for( std::size_t i = 0; i < n; ++i )
+    {
+        v.push_back( F::make() );
+
+        if( observed )
+        {
+            w.push_back( F::observe( v.back() ) );
+        }
+    }
+
+    // in the order of a registry rather than that of the allocator
+    std::shuffle( v.begin(), v.end(), std::minstd_rand( static_cast<unsigned>( n ) ) );
+}
+
+template<class F> void destroy( benchmark::State & state, bool all, bool observed )
+{
+    std::size_t n = static_cast<std::size_t>( state.range( 0 ) );
+
+    std::vector<typename F::owner> v;
+    std::vector<typename F::observer> w;
+
+    v.reserve( n );
+    w.reserve( n );
+
+    for( auto _: state )
+    {
+        state.PauseTiming();
+        make_owners<F>( v, w, n, observed );
+        state.ResumeTiming();
+
+        if( all )
+        {
+            boost::weakable_destroy_all( v );
+        }
+        else
+        {
+            for( auto & p: v )
+            {
+                p.reset();
+            }
+        }
+
+        keep( v.data() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * static_cast<long long>( n ) );
+}
+
+template<class F> void destroy_all( benchmark::State & state )
+{
+    destroy<F>( state, true, false );
+}
+
+template<class F> void destroy_loop( benchmark::State & state )
+{
+    destroy<F>( state, false, false );
+}
+
+template<class F> void destroy_all_observed( benchmark::State & state )
+{
+    destroy<F>( state, true, true );
+}
+
+template<class F> void destroy_loop_observed( benchmark::State & state )
+{
+    destroy<F>( state, false, true );
+}
+
+} // namespace
+
+#define WUP_OWNER_BENCH( f ) \
+    BENCHMARK_TEMPLATE( f, weakable ); \
+    BENCHMARK_TEMPLATE( f, weakable_mt ); \
+    BENCHMARK_TEMPLATE( f, std_unique ); \
+    BENCHMARK_TEMPLATE( f, std_shared ); \
+    BENCHMARK_TEMPLATE( f, boost_shared )
+
+#define WUP_OBSERVER_BENCH( f ) \
+    BENCHMARK_TEMPLATE( f, weakable ); \
+    BENCHMARK_TEMPLATE( f, weakable_mt ); \
+    BENCHMARK_TEMPLATE( f, std_shared ); \
+    BENCHMARK_TEMPLATE( f, boost_shared )
+
+WUP_OWNER_BENCH( construct_destroy );
+BENCHMARK_TEMPLATE( construct_destroy, weakable_compact );
+WUP_OBSERVER_BENCH( construct_observe );
+BENCHMARK_TEMPLATE( construct_observe, weakable_compact );
+WUP_OWNER_BENCH( make_destroy );
+WUP_OWNER_BENCH( move_owner );
+WUP_OWNER_BENCH( reset_owner );
+WUP_OWNER_BENCH( reset_empty );
+WUP_OWNER_BENCH( assign_empty );
+
+WUP_OBSERVER_BENCH( observe );
+WUP_OBSERVER_BENCH( copy_observer );
+WUP_OBSERVER_BENCH( read_live );
+WUP_OBSERVER_BENCH( read_dead );
+WUP_OBSERVER_BENCH( expired_live );
+WUP_OBSERVER_BENCH( expired_dead );
+
+BENCHMARK_TEMPLATE( scan, weakable )->Range( 1 << 10, 1 << 16 );
+BENCHMARK_TEMPLATE( scan, weakable_mt )->Range( 1 << 10, 1 << 16 );
+BENCHMARK_TEMPLATE( scan, std_shared )->Range( 1 << 10, 1 << 16 );
+BENCHMARK_TEMPLATE( scan, boost_shared )->Range( 1 << 10, 1 << 16 );
+
+// weakable_single_threaded observers are not copied across threads
+BENCHMARK_TEMPLATE( read_shared, weakable_mt )->ThreadRange( 1, 8 )->UseRealTime();
+BENCHMARK_TEMPLATE( read_shared, weakable_ca )->ThreadRange( 1, 8 )->UseRealTime();
+BENCHMARK_TEMPLATE( read_shared, std_shared )->ThreadRange( 1, 8 )->UseRealTime();
+BENCHMARK_TEMPLATE( read_shared, boost_shared )->ThreadRange( 1, 8 )->UseRealTime();
+
+BENCHMARK_TEMPLATE( try_get_shared, weakable_mt )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( try_get_shared, weakable_ca )->ThreadRange( 1, 64 )->UseRealTime();
+
+BENCHMARK_TEMPLATE( destroy_all, weakable )->Range( 64, 1 << 18 );
+BENCHMARK_TEMPLATE( destroy_loop, weakable )->Range( 64, 1 << 18 );
+BENCHMARK_TEMPLATE( destroy_all_observed, weakable )->Range( 64, 1 << 18 );
+BENCHMARK_TEMPLATE( destroy_loop_observed, weakable )->Range( 64, 1 << 18 );
+BENCHMARK_TEMPLATE( destroy_all_observed, weakable_mt )->Range( 64, 1 << 18 );
+BENCHMARK_TEMPLATE( destroy_loop_observed, weakable_mt )->Range( 64, 1 << 18 );
+
+BENCHMARK_TEMPLATE( deref_scan, weakable )->Range( 1 << 10, 1 << 18 );
+BENCHMARK_TEMPLATE( deref_scan, weakable_compact )->Range( 1 << 10, 1 << 18 );
+BENCHMARK_TEMPLATE( deref_scan, std_unique )->Range( 1 << 10, 1 << 18 );
+BENCHMARK_TEMPLATE( deref_scan_fused, weakable )->Range( 1 << 10, 1 << 18 );
+BENCHMARK_TEMPLATE( deref_scan_fused, weakable_compact )->Range( 1 << 10, 1 << 18 );
+
+BENCHMARK_TEMPLATE( to_shared_convert, std::shared_ptr<X> );
+BENCHMARK_TEMPLATE( to_shared_release, std::shared_ptr<X> );
+BENCHMARK_TEMPLATE( to_shared_wrap, std_wrap );
+BENCHMARK_TEMPLATE( to_shared_convert, boost::shared_ptr<X> );
+BENCHMARK_TEMPLATE( to_shared_release, boost::shared_ptr<X> );
+BENCHMARK_TEMPLATE( to_shared_wrap, boost_wrap );
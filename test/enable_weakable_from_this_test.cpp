@@ -0,0 +1,142 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+
+struct N: boost::enable_weakable_from_this<N>
+{
+    int v = 1;
+
+    boost::unique_weak_ptr<N> self()
+    {
+        return weak_from_this();
+    }
+};
+
+typedef boost::weakable_multi_threaded MT;
+
+struct M: boost::enable_weakable_from_this<M, MT>
+{
+    int v = 2;
+};
+
+struct Base
+{
+    virtual ~Base() {}
+};
+
+struct Derived: Base, boost::enable_weakable_from_this<Derived>
+{
+};
+
+struct ND: N
+{
+};
+
+// the block of the object stays with it, an owner of Base has no room for it
+static_assert( !std::is_constructible< boost::weakable_unique_ptr<Base>, boost::weakable_unique_ptr<Derived>&& >::value,
+    "an owner of an object with enable_weakable_from_this converts only to an owner of a base with it" );
+static_assert( !std::is_assignable< boost::weakable_unique_ptr<Base>&, boost::weakable_unique_ptr<Derived>&& >::value,
+    "an owner of an object with enable_weakable_from_this converts only to an owner of a base with it" );
+static_assert( !std::is_constructible< boost::weakable_unique_ptr<Base, boost::weakable_inplace_deleter>,
+    boost::weakable_unique_ptr<Derived, boost::weakable_inplace_deleter>&& >::value,
+    "an owner of an object with enable_weakable_from_this converts only to an owner of a base with it" );
+
+static_assert( std::is_nothrow_constructible< boost::weakable_unique_ptr<N>, boost::weakable_unique_ptr<ND>&& >::value,
+    "an owner converts to an owner of a base with enable_weakable_from_this" );
+
+int main()
+{
+    // the block of the object goes with it to the owner of its base
+    {
+        boost::weakable_unique_ptr<ND> p( new ND );
+        auto s = p->self();
+
+        boost::weakable_unique_ptr<N> q( std::move( p ) );
+
+        BOOST_TEST( s.try_get() == q.get() );
+        BOOST_TEST_EQ( q.weak_count(), 1 );
+
+        s.reset();
+        BOOST_TEST( !q.is_observed() );
+
+        s = q->self();
+        q = nullptr;
+
+        BOOST_TEST( s.expired() );
+    }
+
+    BOOST_TEST_EQ( sizeof( boost::weakable_unique_ptr<N> ), sizeof( void* ) );
+
+    boost::unique_weak_ptr<N> w;
+
+    {
+        boost::weakable_unique_ptr<N> p( new N );
+
+        w = p;
+        BOOST_TEST( w.try_get() == p.get() );
+
+        auto s = p->self();
+        BOOST_TEST( s.try_get() == p.get() );
+
+        boost::weakable_unique_ptr<N> q( std::move( p ) );
+        BOOST_TEST( w.try_get() == q.get() );
+
+        // the observers follow the object
+        N * r = q.release();
+        BOOST_TEST( w.try_get() == r );
+
+        q.reset( r );
+        BOOST_TEST( w.try_get() == r );
+    }
+
+    BOOST_TEST( w.expired() );
+
+    {
+        N n;
+
+        w = n.weak_from_this();
+        BOOST_TEST( w.try_get() == &n );
+    }
+
+    BOOST_TEST( w.expired() );
+
+    {
+        auto m = boost::make_weakable_unique<N>();
+
+        w = m;
+
+        auto s = m->self();
+        BOOST_TEST( s.try_get() == m.get() );
+
+        m.reset();
+
+        BOOST_TEST( w.expired() );
+        BOOST_TEST( s.expired() );
+    }
+
+    {
+        auto m = boost::make_weakable_unique<M, MT>();
+        boost::unique_weak_ptr<M, MT> wm( m );
+
+        auto l = wm.lock();
+        BOOST_TEST_EQ( l->v, 2 );
+    }
+
+    // copies do not take the block
+    {
+        N a;
+        auto wa = a.weak_from_this();
+
+        N b( a );
+        b = a;
+
+        BOOST_TEST( wa.try_get() == &a );
+        BOOST_TEST( b.weak_from_this().try_get() == &b );
+    }
+
+    return boost::report_errors();
+}
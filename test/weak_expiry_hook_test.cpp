@@ -0,0 +1,142 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+typedef boost::weakable_hooked<> HP;
+
+struct H final: boost::weak_expiry_hook<>
+{
+    int fired = 0;
+
+    void on_expire() noexcept override
+    {
+        ++fired;
+    }
+};
+
+// unhooks itself from on_expire
+struct U final: boost::weak_expiry_hook<>
+{
+    int fired = 0;
+
+    void on_expire() noexcept override
+    {
+        ++fired;
+        unhook();
+    }
+};
+
+typedef boost::weakable_multi_threaded MT;
+
+struct HM final: boost::weak_expiry_hook<MT>
+{
+    std::atomic<int> fired{ 0 };
+
+    void on_expire() noexcept override
+    {
+        ++fired;
+    }
+};
+
+int main()
+{
+    {
+        boost::weakable_unique_ptr<int, std::default_delete<int>, HP> p( new int( 1 ) );
+        boost::unique_weak_ptr<int, HP> w( p );
+
+        H a, b;
+        U u;
+
+        BOOST_TEST( a.hook( w ) );
+        BOOST_TEST( b.hook( w ) );
+        BOOST_TEST( u.hook( w ) );
+
+        b.unhook();
+        p.reset();
+
+        BOOST_TEST_EQ( a.fired, 1 );
+        BOOST_TEST_EQ( b.fired, 0 );
+        BOOST_TEST_EQ( u.fired, 1 );
+
+        H c;
+
+        BOOST_TEST( !c.hook( w ) );
+        BOOST_TEST( !c.hook( boost::unique_weak_ptr<int, HP>() ) );
+    }
+
+    // the hook keeps the block
+    {
+        H a;
+
+        {
+            auto p = boost::make_weakable_unique<int, HP>( 3 );
+            BOOST_TEST( a.hook( boost::unique_weak_ptr<int, HP>( p ) ) );
+        }
+
+        BOOST_TEST_EQ( a.fired, 1 );
+    }
+
+    // a hook destroyed before the object unhooks
+    {
+        H * a = new H;
+        boost::weakable_unique_ptr<int, std::default_delete<int>, HP> p( new int( 1 ) );
+
+        a->hook( boost::unique_weak_ptr<int, HP>( p ) );
+
+        delete a;
+        p.reset();
+    }
+
+    // hooks are added while the owner goes away: each one is called if
+    // and only if it was added
+    for( int i = 0; i < 100; ++i )
+    {
+        auto p = new boost::weakable_unique_ptr<int, std::default_delete<int>, MT>( new int( 1 ) );
+        boost::unique_weak_ptr<int, MT> w( *p );
+
+        std::vector<HM> hs( 4 );
+        std::atomic<int> hooked( 0 );
+
+        std::thread t( [&]{
+
+            for( auto & h: hs )
+            {
+                if( h.hook( w ) )
+                {
+                    ++hooked;
+                }
+            }
+        });
+
+        delete p;
+        t.join();
+
+        int fired = 0;
+
+        for( auto & h: hs )
+        {
+            fired += h.fired;
+        }
+
+        BOOST_TEST_EQ( fired, hooked.load() );
+    }
+
+    // the hooks are opt-in for the single threaded blocks
+    {
+        BOOST_TEST( !boost::weakable_single_threaded::state::expiry_hooks::value );
+        BOOST_TEST( boost::weakable_hooked<>::state::expiry_hooks::value );
+        BOOST_TEST( MT::state::expiry_hooks::value );
+
+        BOOST_TEST( ( std::is_same<boost::weakable_hooked<MT>::state, MT::state>::value ) );
+        BOOST_TEST( sizeof( boost::weakable_single_threaded::state ) < sizeof( boost::weakable_hooked<>::state ) );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weak_key_map.hpp"
+#include "weakable_handle_table.hpp"
+#include <boost/smart_ptr/owner_less.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+typedef boost::unique_weak_ptr<int> W;
+
+int main()
+{
+    {
+        std::vector< boost::weakable_unique_ptr<int> > o;
+
+        for( int i = 0; i < 1000; ++i )
+        {
+            o.emplace_back( new int( i ) );
+        }
+
+        boost::weak_key_map<int, std::string> m;
+
+        for( int i = 0; i < 1000; ++i )
+        {
+            BOOST_TEST( m.try_emplace( W( o[ i ] ), std::to_string( i ) ).second );
+        }
+
+        BOOST_TEST_EQ( m.size(), 1000u );
+
+        for( int i = 0; i < 1000; ++i )
+        {
+            std::string * v = m.find( W( o[ i ] ) );
+            BOOST_TEST( v && *v == std::to_string( i ) );
+        }
+
+        {
+            auto r = m.try_emplace( W( o[ 5 ] ), "x" );
+
+            BOOST_TEST( !r.second );
+            BOOST_TEST_EQ( *r.first, std::string( "5" ) );
+        }
+
+        W k7( o[ 7 ] );
+
+        for( int i = 0; i < 1000; i += 2 )
+        {
+            o[ i ].reset();
+        }
+
+        // lookups never see an expired key
+        for( int i = 0; i < 1000; ++i )
+        {
+            std::string * v = m.find( W( o[ i ] ) );
+            BOOST_TEST( i % 2 == 0? !v: ( v && *v == std::to_string( i ) ) );
+        }
+
+        BOOST_TEST( m.erase( k7 ) );
+        BOOST_TEST( !m.find( k7 ) );
+        BOOST_TEST( !m.erase( k7 ) );
+
+        m.purge();
+        BOOST_TEST_EQ( m.size(), 499u );
+
+        // new objects, perhaps at the addresses of the old ones
+        for( int i = 0; i < 1000; i += 2 )
+        {
+            o[ i ].reset( new int( i ) );
+            BOOST_TEST( m.try_emplace( W( o[ i ] ), "n" ).second );
+        }
+
+        for( int i = 1; i < 1000; i += 2 )
+        {
+            std::string * v = m.find( W( o[ i ] ) );
+            BOOST_TEST( i == 7? !v: ( v && *v == std::to_string( i ) ) );
+        }
+
+        o.clear();
+
+        for( int i = 0; i < 100; ++i )
+        {
+            boost::weakable_unique_ptr<int> p( new int );
+            m.try_emplace( W( p ), "t" );
+        }
+
+        BOOST_TEST( !m.try_emplace( W() ).first );
+    }
+
+    // comparisons and hashing
+    {
+        boost::weakable_unique_ptr<int> p( new int ), q( new int );
+        W a( p ), b( p ), c( q );
+
+        BOOST_TEST( a == b );
+        BOOST_TEST( a != c );
+        BOOST_TEST( a.owner_equals( b ) );
+        BOOST_TEST( !a.owner_equals( c ) );
+        BOOST_TEST( a.owner_before( c ) != c.owner_before( a ) );
+
+        std::unordered_set<W> s{ a, b, c };
+        BOOST_TEST_EQ( s.size(), 2u );
+
+        std::map<W, int, boost::owner_less<>> om;
+
+        om[ a ] = 1;
+        om[ c ] = 2;
+        om[ b ] = 3;
+
+        BOOST_TEST_EQ( om.size(), 2u );
+
+        // the identity stays after the expiry
+        p.reset();
+
+        BOOST_TEST( a == b );
+        BOOST_TEST_EQ( s.count( a ), 1u );
+    }
+
+    {
+        typedef boost::weakable_generational<> G;
+        typedef boost::unique_weak_ptr<int, G> WG;
+
+        boost::weakable_unique_ptr<int, std::default_delete<int>, G> g( new int );
+        WG a( g ), b( g ), n;
+
+        BOOST_TEST( a == b );
+        BOOST_TEST( a != n );
+        BOOST_TEST_EQ( std::hash<WG>()( a ), b.owner_hash_value() );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weak_observer_list.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <vector>
+
+struct L
+{
+    int n = 0;
+};
+
+typedef boost::weakable_multi_threaded MT;
+
+int main()
+{
+    {
+        std::vector< boost::weakable_unique_ptr<L> > owners;
+        boost::weak_observer_list<L> list;
+
+        for( int i = 0; i < 100; ++i )
+        {
+            owners.emplace_back( new L );
+            list.push_back( boost::unique_weak_ptr<L>( owners.back() ) );
+        }
+
+        // an expired observer is not added
+        list.push_back( boost::unique_weak_ptr<L>() );
+        BOOST_TEST_EQ( list.size(), 100u );
+
+        int n = 0;
+        list.for_each_alive( [&]( L & l ){ ++l.n; ++n; } );
+        BOOST_TEST_EQ( n, 100 );
+
+        for( int i = 0; i < 40; ++i )
+        {
+            owners[ i ].reset();
+        }
+
+        n = 0;
+        list.for_each_alive( [&]( L & ){ ++n; } );
+
+        BOOST_TEST_EQ( n, 60 );
+        BOOST_TEST_EQ( list.size(), 100u );
+
+        // compacted once half are dead
+        for( int i = 40; i < 60; ++i )
+        {
+            owners[ i ].reset();
+        }
+
+        n = 0;
+        list.for_each_alive( [&]( L & ){ ++n; } );
+
+        BOOST_TEST_EQ( n, 40 );
+        BOOST_TEST_EQ( list.size(), 40u );
+
+        boost::weak_observer_list<L> m( std::move( list ) );
+
+        BOOST_TEST( list.empty() );
+        BOOST_TEST_EQ( m.size(), 40u );
+
+        owners.clear();
+        m.compact();
+
+        BOOST_TEST( m.empty() );
+    }
+
+    {
+        boost::weakable_unique_ptr<L, std::default_delete<L>, MT> p( new L );
+        boost::weak_observer_list<L, MT> list;
+
+        list.push_back( boost::unique_weak_ptr<L, MT>( p ) );
+        list.for_each_alive( []( L & l ){ ++l.n; } );
+
+        BOOST_TEST_EQ( p->n, 1 );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Adoption from, and release to, unique_ptr.
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/move/unique_ptr.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <cstdlib>
+#include <new>
+
+// the replaced operator new hands out the memory of malloc, which
+// GCC does not see when it matches free with operator new
+#if defined( BOOST_GCC ) && BOOST_GCC >= 110000
+# pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static int allocs = 0;
+
+void * operator new( std::size_t n )
+{
+    ++allocs;
+
+    if( void * p = std::malloc( n ? n : 1 ) )
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void * p ) noexcept
+{
+    std::free( p );
+}
+
+void operator delete( void * p, std::size_t ) noexcept
+{
+    std::free( p );
+}
+
+struct B
+{
+    virtual ~B() {}
+};
+
+struct D: B
+{
+};
+
+struct Del
+{
+    int id = 7;
+
+    void operator()( int * p ) const
+    {
+        delete p;
+    }
+};
+
+int main()
+{
+    {
+        std::unique_ptr<int> u( new int( 3 ) );
+        int a = allocs;
+
+        boost::weakable_unique_ptr<int> w( std::move( u ) );
+
+        BOOST_TEST( !u );
+        BOOST_TEST_EQ( *w, 3 );
+        BOOST_TEST_EQ( allocs, a );
+
+        boost::unique_weak_ptr<int> o( w );
+        BOOST_TEST_EQ( allocs, a + 1 );
+
+        std::unique_ptr<int> back = w.release_to_unique();
+
+        BOOST_TEST_EQ( *back, 3 );
+        BOOST_TEST( !w );
+        BOOST_TEST( o.expired() );
+
+        w = std::move( back );
+
+        BOOST_TEST_EQ( *w, 3 );
+        BOOST_TEST( !back );
+    }
+
+    {
+        std::unique_ptr<D> u( new D );
+        boost::weakable_unique_ptr<B> w( std::move( u ) );
+
+        BOOST_TEST( w );
+    }
+
+    {
+        std::unique_ptr<int, Del> u( new int( 1 ) );
+        boost::weakable_unique_ptr<int, Del> w( std::move( u ) );
+
+        BOOST_TEST_EQ( w.get_deleter().id, 7 );
+
+        auto b = w.release_to_unique();
+        BOOST_TEST_EQ( b.get_deleter().id, 7 );
+    }
+
+    {
+        boost::movelib::unique_ptr<int> u( new int( 4 ) );
+        boost::weakable_unique_ptr<int> w( std::move( u ) );
+
+        BOOST_TEST_EQ( *w, 4 );
+        BOOST_TEST( !u );
+
+        u.reset( new int( 5 ) );
+        w = std::move( u );
+
+        BOOST_TEST_EQ( *w, 5 );
+    }
+
+    {
+        typedef boost::weakable_compact<> C;
+
+        std::unique_ptr<int> u( new int( 3 ) );
+        boost::weakable_unique_ptr<int, std::default_delete<int>, C> w( std::move( u ) );
+        BOOST_TEST_EQ( *w, 3 );
+
+        auto b = w.release_to_unique();
+        BOOST_TEST_EQ( *b, 3 );
+
+        std::unique_ptr<int> e;
+        boost::weakable_unique_ptr<int, std::default_delete<int>, C> w2( std::move( e ) );
+        BOOST_TEST( !w2 );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weak_observer_list.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <string>
+
+struct Conn
+{
+    int id = 3;
+    std::string buf = "abc";
+    int arr[ 4 ] = { 1, 2, 3, 4 };
+};
+
+int main()
+{
+    {
+        auto c = boost::make_weakable_unique<Conn>();
+
+        boost::unique_weak_ptr<std::string> b( c, &c->buf );
+        boost::unique_weak_ptr<Conn> wc( c );
+        boost::unique_weak_ptr<int> e( wc, &c->arr[ 2 ] );
+        boost::unique_weak_ptr<const int> e2( boost::unique_weak_ptr<Conn>( wc ), &c->id );
+
+        BOOST_TEST_EQ( *b.try_get(), std::string( "abc" ) );
+        BOOST_TEST_EQ( *e.try_get(), 3 );
+        BOOST_TEST_EQ( *e2.try_get(), 3 );
+
+        // the identity is the one of the object
+        BOOST_TEST( b.owner_equals( wc ) );
+        BOOST_TEST( !b.owner_before( wc ) );
+        BOOST_TEST( !wc.owner_before( b ) );
+
+        BOOST_TEST_EQ( c.weak_count(), 4 );
+
+        {
+            auto l = b.lock();
+            BOOST_TEST_EQ( l->size(), 3u );
+        }
+
+        boost::weak_observer_list<int> list;
+        list.push_back( e );
+
+        int seen = 0;
+        list.for_each_alive( [&]( int & x ){ seen = x; } );
+
+        BOOST_TEST_EQ( seen, 3 );
+
+        boost::unique_weak_ptr<int> n( boost::unique_weak_ptr<Conn>(), &c->id );
+        BOOST_TEST( n.expired() );
+
+        c.reset();
+
+        BOOST_TEST( b.expired() );
+        BOOST_TEST( e.expired() );
+        BOOST_TEST( e2.expired() );
+        BOOST_TEST( !b.try_get() );
+    }
+
+    {
+        typedef boost::weakable_multi_threaded MT;
+
+        boost::weakable_unique_ptr<Conn, std::default_delete<Conn>, MT> m( new Conn );
+        boost::unique_weak_ptr<int, MT> w( m, &m->id );
+
+        BOOST_TEST_EQ( *w.lock(), 3 );
+
+        // a null alias pins and borrows like any other, and lets go
+        boost::unique_weak_ptr<int, MT> z( m, static_cast<int*>( nullptr ) );
+
+        BOOST_TEST( !z.lock() );
+        BOOST_TEST( !z.try_borrow() );
+
+        {
+            auto l = z.lock();
+            auto l2( std::move( l ) );
+        }
+
+        m.reset();
+        BOOST_TEST( z.expired() );
+    }
+
+    return boost::report_errors();
+}
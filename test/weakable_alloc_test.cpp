@@ -0,0 +1,118 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// The allocations of owners: lazy control blocks, and blocks
+// reused by reset(p) when nobody observes the object.
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <cstdlib>
+#include <new>
+
+static int allocs = 0;
+
+void * operator new( std::size_t n )
+{
+    ++allocs;
+
+    if( void * p = std::malloc( n ? n : 1 ) )
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void * p ) noexcept
+{
+    std::free( p );
+}
+
+void operator delete( void * p, std::size_t ) noexcept
+{
+    std::free( p );
+}
+
+typedef boost::weakable_compact<> C;
+
+int main()
+{
+    // the block is created by the first observer
+    {
+        int a = allocs;
+
+        boost::weakable_unique_ptr<int> p( new int( 1 ) );
+        BOOST_TEST_EQ( allocs, a + 1 );
+
+        boost::unique_weak_ptr<int> w( p );
+        BOOST_TEST_EQ( allocs, a + 2 );
+
+        boost::unique_weak_ptr<int> w2( p );
+        BOOST_TEST_EQ( allocs, a + 2 );
+    }
+
+    {
+        int a = allocs;
+
+        boost::weakable_unique_ptr<int, std::default_delete<int>, C> p( nullptr );
+        p.reset();
+
+        boost::weakable_unique_ptr<int, std::default_delete<int>, C> q( static_cast<int*>( 0 ) );
+        q.reset( nullptr );
+
+        BOOST_TEST_EQ( allocs, a );
+    }
+
+    // reset(p) keeps the block of an unobserved object
+    {
+        boost::weakable_unique_ptr<int, std::default_delete<int>, C> p( new int( 1 ) );
+
+        int a = allocs;
+        p.reset( new int( 2 ) );
+
+        BOOST_TEST_EQ( allocs, a + 1 );
+        BOOST_TEST_EQ( *p, 2 );
+
+        boost::unique_weak_ptr<int, C> w( p );
+
+        a = allocs;
+        p.reset( new int( 3 ) );
+
+        BOOST_TEST_EQ( allocs, a + 2 );
+        BOOST_TEST( w.expired() );
+        BOOST_TEST_EQ( *p, 3 );
+
+        boost::unique_weak_ptr<int, C> w2( p );
+        w2.reset();
+
+        a = allocs;
+        p.reset( new int( 4 ) );
+
+        BOOST_TEST_EQ( allocs, a + 1 );
+        BOOST_TEST_EQ( *p, 4 );
+
+        boost::unique_weak_ptr<int, C> w3( p );
+        BOOST_TEST( w3.try_get() == p.get() );
+    }
+
+    {
+        boost::weakable_unique_ptr<int> p( new int( 1 ) );
+        boost::unique_weak_ptr<int> w( p );
+        w.reset();
+
+        int a = allocs;
+        p.reset( new int( 2 ) );
+        BOOST_TEST_EQ( allocs, a + 1 );
+
+        boost::unique_weak_ptr<int> w2( p );
+        BOOST_TEST_EQ( allocs, a + 1 );
+        BOOST_TEST_EQ( *w2.try_get(), 2 );
+
+        p.reset( new int( 5 ) );
+        BOOST_TEST( w2.expired() );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <string>
+#include <thread>
+
+#if defined( __has_include )
+# if __has_include( <memory_resource> ) && __cplusplus >= 201703L
+#  include <memory_resource>
+#  define WUP_TEST_PMR
+# endif
+#endif
+
+typedef boost::weakable_pooled<> P;
+
+int main()
+{
+    for( int i = 0; i < 3; ++i )
+    {
+        boost::weakable_unique_ptr<int, std::default_delete<int>, P> p( new int( i ) );
+        boost::unique_weak_ptr<int, P> w( p );
+
+        BOOST_TEST_EQ( *w.try_get(), i );
+    }
+
+    // blocks of a thread that has exited
+    std::thread( []{
+
+        boost::weakable_unique_ptr<int, std::default_delete<int>, P> p( new int( 1 ) );
+        boost::unique_weak_ptr<int, P> w( p );
+
+    } ).join();
+
+    {
+        auto m = boost::allocate_weakable_unique<std::string>( boost::weakable_pool_allocator<char>(), "a string longer than the small buffer" );
+        boost::unique_weak_ptr<std::string> w( m );
+
+        BOOST_TEST_EQ( w.try_get()->size(), 37u );
+    }
+
+    {
+        typedef boost::weakable_compact<P> CP;
+
+        boost::weakable_unique_ptr<int, std::default_delete<int>, CP> p( new int( 3 ) );
+        boost::unique_weak_ptr<int, CP> w( p );
+
+        BOOST_TEST_EQ( *w.try_get(), 3 );
+    }
+
+#if defined( WUP_TEST_PMR )
+
+    {
+        std::pmr::monotonic_buffer_resource arena;
+
+        {
+            boost::weakable_unique_ptr<int> p( new int( 3 ), std::default_delete<int>(), std::pmr::polymorphic_allocator<char>( &arena ) );
+            boost::unique_weak_ptr<int> w( p );
+
+            BOOST_TEST_EQ( *w.try_get(), 3 );
+        }
+
+        {
+            auto m = boost::allocate_weakable_unique<std::string>( std::pmr::polymorphic_allocator<char>( &arena ), "x" );
+            BOOST_TEST_EQ( *m, std::string( "x" ) );
+        }
+    }
+
+#endif
+
+    return boost::report_errors();
+}
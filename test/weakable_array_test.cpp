@@ -0,0 +1,185 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <cstdint>
+#include <new>
+#include <string>
+
+static int live = 0;
+
+struct X
+{
+    std::string s = "x";
+
+    X()
+    {
+        ++live;
+    }
+
+    ~X()
+    {
+        --live;
+    }
+};
+
+struct alignas( 64 ) W
+{
+    char c[ 3 ];
+};
+
+struct T
+{
+    static int n;
+
+    T()
+    {
+        if( ++n == 3 )
+        {
+            throw 1;
+        }
+
+        ++live;
+    }
+
+    ~T()
+    {
+        --live;
+    }
+};
+
+int T::n = 0;
+
+int main()
+{
+    {
+        auto a = boost::make_weakable_unique<X[]>( 5 );
+
+        BOOST_TEST_EQ( live, 5 );
+        BOOST_TEST_EQ( a[ 3 ].s, std::string( "x" ) );
+
+        boost::unique_weak_ptr<X[]> w( a );
+        auto s = w.try_get();
+
+        BOOST_TEST( s );
+        BOOST_TEST_EQ( s.size(), 5u );
+        BOOST_TEST( s.data() == a.get() );
+        BOOST_TEST( &s[ 4 ] == &a[ 4 ] );
+
+        int n = 0;
+
+        for( X & x: s )
+        {
+            ( void )x;
+            ++n;
+        }
+
+        BOOST_TEST_EQ( n, 5 );
+
+        boost::unique_weak_ptr<const X[]> wc( w );
+        BOOST_TEST_EQ( wc.try_get().size(), 5u );
+
+        {
+            auto l = w.lock();
+            BOOST_TEST_EQ( l[ 0 ].s, std::string( "x" ) );
+        }
+
+        boost::weakable_unique_ptr<X[], boost::weakable_inplace_deleter> b( std::move( a ) );
+        BOOST_TEST_EQ( w.try_get().size(), 5u );
+
+        b.reset();
+
+        BOOST_TEST_EQ( live, 0 );
+        BOOST_TEST( !w.try_get() );
+        BOOST_TEST( w.try_get().empty() );
+        BOOST_TEST( w.expired() );
+        BOOST_TEST( wc.expired() );
+    }
+
+    {
+        boost::weakable_unique_ptr<int[]> p( new int[ 4 ]{ 1, 2, 3, 4 }, 4 );
+        boost::unique_weak_ptr<int[]> w( p );
+
+        BOOST_TEST_EQ( w.try_get().size(), 4u );
+        BOOST_TEST_EQ( w.try_get()[ 2 ], 3 );
+
+        boost::weakable_unique_ptr<int[]> q( new int[ 2 ], 2 );
+
+        p.swap( q );
+
+        boost::unique_weak_ptr<int[]> w2( q );
+        BOOST_TEST_EQ( w2.try_get().size(), 4u );
+
+        q.reset( new int[ 3 ], 3 );
+
+        boost::unique_weak_ptr<int[]> w3( q );
+        BOOST_TEST_EQ( w3.try_get().size(), 3u );
+        BOOST_TEST( w2.expired() );
+
+        // the observers see the length of the new array
+        q.reset( new int[ 5 ], 5 );
+        BOOST_TEST_EQ( boost::unique_weak_ptr<int[]>( q ).try_get().size(), 5u );
+    }
+
+    // a unique_ptr does not know the length of its array
+    {
+        std::unique_ptr<int[]> u( new int[ 6 ]() );
+        boost::weakable_unique_ptr<int[]> p( std::move( u ), 6 );
+        boost::unique_weak_ptr<int[]> w( p );
+
+        BOOST_TEST( !u );
+        BOOST_TEST_EQ( w.try_get().size(), 6u );
+        BOOST_TEST( !w.try_get().empty() );
+
+        p.reset();
+        BOOST_TEST( w.try_get().empty() );
+    }
+
+    {
+        auto a = boost::make_weakable_unique<W[]>( 3 );
+        BOOST_TEST_EQ( reinterpret_cast<std::uintptr_t>( a.get() ) % 64, 0u );
+    }
+
+    // the constructed elements are destroyed
+    try
+    {
+        boost::make_weakable_unique<T[]>( 5 );
+        BOOST_ERROR( "make_weakable_unique<T[]> did not throw" );
+    }
+    catch( int )
+    {
+    }
+
+    BOOST_TEST_EQ( live, 0 );
+
+    {
+        auto a = boost::make_weakable_unique<int[]>( 0 );
+        boost::unique_weak_ptr<int[]> w( a );
+
+        BOOST_TEST_EQ( w.try_get().size(), 0u );
+    }
+
+    {
+        typedef boost::weakable_compact<> C;
+
+        auto a = boost::make_weakable_unique<int[], C>( 7 );
+        BOOST_TEST_EQ( a[ 6 ], 0 );
+
+        boost::unique_weak_ptr<int[], C> w( a );
+        BOOST_TEST_EQ( w.try_get().size(), 7u );
+    }
+
+    try
+    {
+        boost::make_weakable_unique<int[]>( std::size_t( -1 ) / 2 );
+        BOOST_ERROR( "make_weakable_unique<int[]> did not throw" );
+    }
+    catch( std::bad_alloc const & )
+    {
+    }
+
+    return boost::report_errors();
+}
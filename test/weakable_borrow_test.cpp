@@ -0,0 +1,146 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_instrumented.hpp"
+#include "weakable_epoch.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+typedef boost::weakable_multi_threaded MT;
+
+static std::atomic<int> live( 0 );
+
+struct X
+{
+    int v = 0;
+
+    X()
+    {
+        ++live;
+    }
+
+    ~X()
+    {
+        --live;
+    }
+};
+
+template<class P> void test_policy()
+{
+    boost::weakable_unique_ptr<X, std::default_delete<X>, P> p( new X );
+    boost::unique_weak_ptr<X, P> w( p ), w2( w );
+
+    {
+        auto b = w.try_borrow();
+        BOOST_TEST( b );
+
+        // one borrower at a time, readers are not kept out
+        BOOST_TEST( !w2.try_borrow() );
+        BOOST_TEST( w2.lock() );
+
+        b->v = 1;
+    }
+
+    BOOST_TEST_EQ( w2.try_borrow()->v, 1 );
+
+    p.reset();
+    BOOST_TEST( !w.try_borrow() );
+}
+
+int main()
+{
+    // a single thread can not wait for its own borrower
+    BOOST_TEST( !boost::weakable_single_threaded::state::borrowing::value );
+
+    test_policy<MT>();
+    test_policy<boost::weakable_cache_aligned>();
+    test_policy< boost::weakable_instrumented<MT> >();
+    test_policy<boost::weakable_epoch>();
+
+    boost::weakable_epoch_barrier();
+    BOOST_TEST_EQ( live.load(), 0 );
+
+    // borrowers exclude each other, the owner waits for them
+    for( int i = 0; i < 50; ++i )
+    {
+        auto p = new boost::weakable_unique_ptr<X, std::default_delete<X>, MT>( new X );
+        boost::unique_weak_ptr<X, MT> w( *p );
+
+        std::atomic<int> inside( 0 ), bad( 0 );
+        std::vector<std::thread> ts;
+
+        for( int t = 0; t < 4; ++t )
+        {
+            ts.emplace_back( [w, &inside, &bad]{
+
+                for( int k = 0; k < 2000; ++k )
+                {
+                    if( auto b = w.try_borrow() )
+                    {
+                        if( inside.fetch_add( 1 ) != 0 || live < 1 ) ++bad;
+
+                        ++b->v;
+                        inside.fetch_sub( 1 );
+                    }
+                }
+            });
+        }
+
+        std::this_thread::yield();
+        delete p;
+
+        for( auto & t: ts )
+        {
+            t.join();
+        }
+
+        BOOST_TEST_EQ( bad.load(), 0 );
+    }
+
+    BOOST_TEST_EQ( live.load(), 0 );
+
+    // a borrow that outlives its observer keeps the owner waiting
+    {
+        auto p = new boost::weakable_unique_ptr<X, std::default_delete<X>, MT>( new X );
+
+        std::atomic<bool> held( false ), done( false );
+        std::atomic<int> bad( 0 );
+
+        std::thread t( [&]{
+
+            boost::unique_weak_ptr<X, MT> w( *p );
+
+            auto b = w.try_borrow();
+            w.reset();
+
+            held = true;
+
+            for( int k = 0; k < 200; ++k )
+            {
+                if( live != 1 ) ++bad;
+                std::this_thread::yield();
+            }
+
+            done = true;
+        });
+
+        while( !held )
+        {
+            std::this_thread::yield();
+        }
+
+        delete p;
+
+        BOOST_TEST( done );
+
+        t.join();
+
+        BOOST_TEST_EQ( bad.load(), 0 );
+    }
+
+    return boost::report_errors();
+}
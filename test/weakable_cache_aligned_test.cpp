@@ -0,0 +1,97 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_instrumented.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+typedef boost::weakable_cache_aligned CA;
+
+template<class P> void test_inplace()
+{
+    auto m = boost::make_weakable_unique<int, P>( 5 );
+    boost::unique_weak_ptr<int, P> wm( m );
+
+    auto a = boost::make_weakable_unique<long[], P>( 10 );
+    boost::unique_weak_ptr<long[], P> wa( a );
+
+    BOOST_TEST_EQ( *wm.try_get(), 5 );
+    BOOST_TEST_EQ( wa.try_get().size(), 10u );
+
+    // the objects made in place start on a line of their own,
+    // unless the state is not split as without threads
+    BOOST_TEST_EQ( P::state::split::value, CA::state::split::value );
+
+    if( P::state::split::value )
+    {
+        BOOST_TEST_EQ( reinterpret_cast<std::uintptr_t>( m.get() ) % BOOST_WUP_CACHE_LINE_SIZE, 0u );
+        BOOST_TEST_EQ( reinterpret_cast<std::uintptr_t>( a.get() ) % BOOST_WUP_CACHE_LINE_SIZE, 0u );
+    }
+}
+
+int main()
+{
+    BOOST_TEST( sizeof( boost::detail::weakable_unique_ptr_control_block<boost::weakable_multi_threaded> ) < BOOST_WUP_CACHE_LINE_SIZE );
+
+    {
+        std::vector< boost::weakable_unique_ptr<int, std::default_delete<int>, CA> > v;
+        std::vector< boost::unique_weak_ptr<int, CA> > w;
+
+        for( int i = 0; i < 100; ++i )
+        {
+            v.emplace_back( new int( i ) );
+            w.emplace_back( v.back() );
+        }
+
+        std::atomic<int> bad( 0 );
+
+        std::thread t( [&]{
+
+            for( int k = 0; k < 100; ++k )
+            {
+                for( int i = 0; i < 100; ++i )
+                {
+                    auto l = w[ i ].lock();
+
+                    if( l && *l != i )
+                    {
+                        ++bad;
+                    }
+                }
+            }
+        });
+
+        for( int i = 0; i < 100; ++i )
+        {
+            v[ i ].reset();
+        }
+
+        t.join();
+
+        BOOST_TEST_EQ( bad.load(), 0 );
+
+        for( int i = 0; i < 100; ++i )
+        {
+            BOOST_TEST( w[ i ].expired() );
+        }
+    }
+
+    test_inplace<CA>();
+    test_inplace< boost::weakable_instrumented<CA> >();
+
+    {
+        typedef boost::weakable_compact<CA> C;
+
+        boost::weakable_unique_ptr<int, std::default_delete<int>, C> c( new int( 3 ) );
+        boost::unique_weak_ptr<int, C> wc( c );
+
+        BOOST_TEST_EQ( *wc.try_get(), 3 );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+
+typedef boost::weakable_compact<> C;
+
+int main()
+{
+    BOOST_TEST_EQ( sizeof( boost::weakable_unique_ptr<int, std::default_delete<int>, C> ), sizeof( void* ) );
+
+    {
+        boost::weakable_unique_ptr<int, std::default_delete<int>, C> p( new int( 3 ) );
+        BOOST_TEST_EQ( *p, 3 );
+
+        boost::unique_weak_ptr<int, C> w( p );
+        BOOST_TEST( w.try_get() == p.get() );
+
+        int * r = p.release();
+
+        BOOST_TEST( w.expired() );
+        BOOST_TEST( !p );
+
+        delete r;
+
+        p.reset( new int( 4 ) );
+        w = p;
+        BOOST_TEST_EQ( *w.try_get(), 4 );
+
+        p = nullptr;
+        BOOST_TEST( w.expired() );
+    }
+
+    {
+        auto m = boost::make_weakable_unique<int, C>( 9 );
+        BOOST_TEST_EQ( sizeof( m ), sizeof( void* ) );
+
+        boost::unique_weak_ptr<int, C> w( m );
+        BOOST_TEST_EQ( *w.try_get(), 9 );
+
+        m.reset();
+        BOOST_TEST( w.expired() );
+    }
+
+    // an eager block can fail to allocate, a lazy one can not
+    {
+        boost::weakable_unique_ptr<int, std::default_delete<int>, C> p;
+        boost::weakable_unique_ptr<int> q;
+
+        BOOST_TEST( !noexcept( p.reset( nullptr ) ) );
+        BOOST_TEST( noexcept( q.reset( nullptr ) ) );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include "weakable_handle_table.hpp"
+#include <boost/core/lightweight_test.hpp>
+
+// constant initialized, before any dynamic initialization
+static boost::unique_weak_ptr<int> table[ 4 ];
+static boost::unique_weak_ptr<int[]> array_table[ 2 ];
+static boost::weakable_unique_ptr<int> owner_table[ 2 ];
+
+#if defined( __cpp_constexpr_dynamic_alloc )
+
+typedef boost::weakable_unique_ptr<int, std::default_delete<int>, boost::weakable_compact<>> compact_owner;
+
+constexpr bool test_null()
+{
+    boost::unique_weak_ptr<int> a, b;
+    boost::unique_weak_ptr<int> c( a );
+    boost::unique_weak_ptr<int> d( std::move( c ) );
+
+    a = b;
+    a = std::move( d );
+    a.swap( b );
+    a.reset();
+
+    compact_owner o;
+
+    boost::unique_weak_ptr<int, boost::weakable_generational<>> g, h;
+
+    g.swap( h );
+    g.reset();
+
+    return a.expired() && a.try_get() == nullptr && a == b && !( a != b )
+        && a.owner_equals( b ) && !a.owner_before( b )
+        && !o && o.get() == nullptr && g == h;
+}
+
+// The lazy owner reads a mutable block pointer, which GCC does not take
+// in a constant expression even where the owner was made in it; it can
+// only be constant initialized, as owner_table is.
+template<class O, class A>
+constexpr bool test_owner()
+{
+    O a, b( nullptr );
+
+    O c( std::move( a ) );
+
+    a = std::move( c );
+    a = nullptr;
+    a.swap( b );
+    a.reset();
+
+    A d;
+    d.reset();
+
+    return !a && a.get() == nullptr && !b && !c && !d;
+}
+
+static_assert( test_owner< compact_owner, boost::weakable_unique_ptr<int[], std::default_delete<int[]>, boost::weakable_compact<>> >(),
+    "null owners are usable in constant expressions" );
+
+static_assert( test_null(), "null observers are usable in constant expressions" );
+
+constexpr bool test_array()
+{
+    boost::unique_weak_ptr<int[]> a;
+    return a.try_get().empty() && a.try_get().size() == 0;
+}
+
+static_assert( test_array(), "null array observers are usable in constant expressions" );
+
+#endif
+
+int main()
+{
+    auto p = boost::make_weakable_unique<int>( 5 );
+
+    table[ 1 ] = p;
+    BOOST_TEST_EQ( *table[ 1 ].try_get(), 5 );
+
+    table[ 1 ].swap( table[ 2 ] );
+
+    BOOST_TEST( table[ 1 ].expired() );
+    BOOST_TEST( !table[ 2 ].expired() );
+    BOOST_TEST_EQ( p.weak_count(), 1 );
+
+    boost::unique_weak_ptr<int> x( table[ 2 ] );
+    BOOST_TEST( x == table[ 2 ] );
+
+    p.reset();
+
+    BOOST_TEST( x.expired() );
+    BOOST_TEST( table[ 2 ].expired() );
+
+    owner_table[ 0 ].reset( new int( 1 ) );
+    BOOST_TEST_EQ( *owner_table[ 0 ], 1 );
+
+    auto a = boost::make_weakable_unique<int[]>( 3 );
+
+    array_table[ 0 ] = a;
+    BOOST_TEST_EQ( array_table[ 0 ].try_get().size(), 3u );
+
+    return boost::report_errors();
+}
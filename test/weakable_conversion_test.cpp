@@ -0,0 +1,114 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+
+struct A
+{
+    int a = 1;
+    virtual ~A() {}
+};
+
+struct B
+{
+    int b = 2;
+    virtual ~B() {}
+};
+
+struct D: A, B
+{
+    int d = 3;
+};
+
+struct V: virtual B
+{
+    int v = 4;
+};
+
+struct E: boost::enable_weakable_from_this<E>
+{
+    int e = 5;
+    virtual ~E() {}
+};
+
+struct F: E
+{
+    int f = 6;
+};
+
+typedef boost::weakable_compact<> C;
+
+int main()
+{
+    {
+        boost::weakable_unique_ptr<D> pd( new D );
+        boost::unique_weak_ptr<D> wd( pd );
+        boost::unique_weak_ptr<B> wb( wd );
+
+        BOOST_TEST( wb.try_get() == static_cast<B*>( pd.get() ) );
+        BOOST_TEST_EQ( wb.try_get()->b, 2 );
+
+        boost::unique_weak_ptr<B> wb2( pd );
+        BOOST_TEST( wb2.try_get() == wb.try_get() );
+
+        boost::weakable_unique_ptr<B> pb( std::move( pd ) );
+        BOOST_TEST( wb.try_get() == pb.get() );
+        BOOST_TEST_EQ( wb.lock()->b, 2 );
+
+        boost::unique_weak_ptr<const B> wcb( std::move( wb2 ) );
+        BOOST_TEST( wcb.try_get() == pb.get() );
+
+        pb.reset();
+
+        BOOST_TEST( wb.expired() );
+        BOOST_TEST( wcb.expired() );
+        BOOST_TEST( !wd.lock() );
+
+        boost::unique_weak_ptr<B> wx( wd );
+        BOOST_TEST( wx.expired() );
+    }
+
+    {
+        boost::weakable_unique_ptr<D, std::default_delete<D>, C> cd( new D );
+        boost::unique_weak_ptr<D, C> cwd( cd );
+        boost::weakable_unique_ptr<B, std::default_delete<B>, C> cb( std::move( cd ) );
+
+        BOOST_TEST_EQ( cb->b, 2 );
+        BOOST_TEST_EQ( cwd.try_get()->d, 3 );
+
+        cb.reset();
+        BOOST_TEST( cwd.expired() );
+    }
+
+    // the object is read to convert to a virtual base
+    {
+        auto v = boost::make_weakable_unique<V>();
+        boost::unique_weak_ptr<V> wv( v );
+        boost::unique_weak_ptr<B> wvb( wv );
+
+        BOOST_TEST_EQ( wvb.try_get()->b, 2 );
+    }
+
+    {
+        auto f = boost::make_weakable_unique<F>();
+        boost::unique_weak_ptr<E> we = f->weak_from_this();
+
+        const F & cf = *f;
+        boost::unique_weak_ptr<const E> wce = cf.weak_from_this();
+
+        boost::weakable_unique_ptr<E, boost::weakable_inplace_deleter> fe( std::move( f ) );
+
+        BOOST_TEST( we.try_get() == fe.get() );
+        BOOST_TEST( wce.try_get() == fe.get() );
+
+        fe.reset();
+
+        BOOST_TEST( we.expired() );
+        BOOST_TEST( wce.expired() );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,129 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include "weakable_epoch.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <list>
+#include <vector>
+
+static int live = 0;
+
+struct X
+{
+    X()
+    {
+        ++live;
+    }
+
+    ~X()
+    {
+        --live;
+    }
+};
+
+struct Y: boost::enable_weakable_from_this<Y>
+{
+    Y()
+    {
+        ++live;
+    }
+
+    ~Y()
+    {
+        --live;
+    }
+};
+
+template<class O, class F> void test( F make, std::size_t n )
+{
+    typedef typename O::element_type E;
+    typedef typename O::policy_type P;
+
+    boost::weakable_epoch_barrier();
+
+    std::vector<O> v;
+    std::vector< boost::unique_weak_ptr<E, P> > w;
+
+    for( std::size_t i = 0; i < n; ++i )
+    {
+        v.push_back( make() );
+
+        if( i % 3 == 0 )
+        {
+            w.push_back( boost::unique_weak_ptr<E, P>( v.back() ) );
+        }
+    }
+
+    v.push_back( O() );
+
+    BOOST_TEST_EQ( live, static_cast<int>( n ) );
+
+    boost::weakable_destroy_all( v );
+    boost::weakable_epoch_barrier();
+
+    BOOST_TEST_EQ( live, 0 );
+
+    for( auto & o: v )
+    {
+        BOOST_TEST( !o );
+        BOOST_TEST_EQ( o.weak_count(), 0 );
+    }
+
+    for( auto & x: w )
+    {
+        BOOST_TEST( x.expired() );
+    }
+
+    // the owners are usable again
+    v[ 0 ] = make();
+    BOOST_TEST_EQ( live, 1 );
+}
+
+typedef boost::weakable_inplace_deleter I;
+typedef boost::weakable_multi_threaded MT;
+typedef boost::weakable_compact<> C;
+typedef boost::weakable_pooled<> P;
+typedef boost::weakable_epoch E;
+
+int main()
+{
+    std::size_t const sizes[] = { 0, 1, 63, 64, 65, 200 };
+
+    for( std::size_t n: sizes )
+    {
+        test< boost::weakable_unique_ptr<X> >( []{ return boost::weakable_unique_ptr<X>( new X ); }, n );
+        test< boost::weakable_unique_ptr<X, I> >( []{ return boost::make_weakable_unique<X>(); }, n );
+        test< boost::weakable_unique_ptr<X, I, MT> >( []{ return boost::make_weakable_unique<X, MT>(); }, n );
+        test< boost::weakable_unique_ptr<X, std::default_delete<X>, C> >( []{ return boost::weakable_unique_ptr<X, std::default_delete<X>, C>( new X ); }, n );
+        test< boost::weakable_unique_ptr<X, I, P> >( []{ return boost::make_weakable_unique<X, P>(); }, n );
+        test< boost::weakable_unique_ptr<X, I, E> >( []{ return boost::make_weakable_unique<X, E>(); }, n );
+        test< boost::weakable_unique_ptr<Y> >( []{ return boost::weakable_unique_ptr<Y>( new Y ); }, n );
+        test< boost::weakable_unique_ptr<Y, I> >( []{ return boost::make_weakable_unique<Y>(); }, n );
+        test< boost::weakable_unique_ptr<X, boost::weakable_erased_deleter> >( []{ return boost::weakable_unique_ptr<X, boost::weakable_erased_deleter>( new X, std::default_delete<X>() ); }, n );
+    }
+
+    BOOST_TEST_EQ( live, 0 );
+
+    {
+        std::vector< boost::weakable_unique_ptr<X[], I> > a;
+        a.push_back( boost::make_weakable_unique<X[]>( 3 ) );
+
+        boost::unique_weak_ptr<X[]> wa( a[ 0 ] );
+
+        std::list< boost::weakable_unique_ptr<X[], I> > l;
+        l.push_back( boost::make_weakable_unique<X[]>( 2 ) );
+
+        BOOST_TEST_EQ( live, 5 );
+
+        boost::weakable_destroy_all( a.begin(), a.end() );
+        boost::weakable_destroy_all( l );
+
+        BOOST_TEST_EQ( live, 0 );
+        BOOST_TEST( wa.expired() );
+    }
+
+    return boost::report_errors();
+}
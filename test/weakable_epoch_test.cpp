@@ -0,0 +1,201 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_epoch.hpp"
+#include "weakable_instrumented.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+typedef boost::weakable_epoch E;
+typedef boost::weakable_instrumented<E> IE;
+
+// a lock of a wrapped epoch state is bound to its thread as well
+static_assert( IE::state::thread_bound_pin::value, "the instrumented epoch state pins on the thread of the reader" );
+
+static std::atomic<int> live( 0 );
+
+struct X
+{
+    int v;
+
+    explicit X( int v_ ): v( v_ )
+    {
+        ++live;
+    }
+
+    ~X()
+    {
+        v = -1;
+        --live;
+    }
+};
+
+struct F: boost::enable_weakable_from_this<F, E>
+{
+    int v = 7;
+};
+
+int main()
+{
+    // the object stays until the readers have left
+    {
+        boost::weakable_unique_ptr<X, std::default_delete<X>, E> p( new X( 1 ) );
+        boost::unique_weak_ptr<X, E> w( p );
+
+        {
+            boost::weakable_epoch_guard g;
+
+            BOOST_TEST_EQ( w.try_get()->v, 1 );
+
+            p.reset();
+
+            BOOST_TEST( w.expired() );
+            BOOST_TEST_EQ( live.load(), 1 );
+        }
+
+        boost::weakable_epoch_barrier();
+        BOOST_TEST_EQ( live.load(), 0 );
+    }
+
+    {
+        auto q = boost::make_weakable_unique<X, E>( 3 );
+        boost::unique_weak_ptr<X, E> w( q );
+
+        {
+            auto l = w.lock();
+            BOOST_TEST_EQ( l->v, 3 );
+        }
+
+        q.reset();
+        boost::weakable_epoch_barrier();
+
+        BOOST_TEST_EQ( live.load(), 0 );
+    }
+
+    // release() waits for the readers instead
+    {
+        boost::weakable_unique_ptr<X, std::default_delete<X>, E> r( new X( 4 ) );
+        boost::unique_weak_ptr<X, E> w( r );
+
+        X * raw = r.release();
+
+        BOOST_TEST( w.expired() );
+        delete raw;
+    }
+
+    {
+        auto f = boost::make_weakable_unique<F, E>();
+        auto w = f->weak_from_this();
+
+        f.reset();
+        boost::weakable_epoch_barrier();
+
+        BOOST_TEST( w.expired() );
+    }
+
+    {
+        typedef boost::weakable_compact<E> CE;
+
+        boost::weakable_unique_ptr<X, std::default_delete<X>, CE> c( new X( 5 ) );
+        boost::unique_weak_ptr<X, CE> w( c );
+
+        c.reset();
+        boost::weakable_epoch_barrier();
+
+        BOOST_TEST_EQ( live.load(), 0 );
+    }
+
+    // readers never see a destroyed object
+    {
+        int const N = 64;
+
+        std::vector< boost::weakable_unique_ptr<X, std::default_delete<X>, E> > owners;
+        std::vector< boost::unique_weak_ptr<X, E> > ws;
+
+        for( int i = 0; i < N; ++i )
+        {
+            owners.emplace_back( new X( i ) );
+            ws.emplace_back( owners.back() );
+        }
+
+        std::atomic<bool> stop( false );
+        std::atomic<int> bad( 0 );
+        std::vector<std::thread> readers;
+
+        for( int t = 0; t < 4; ++t )
+        {
+            readers.emplace_back( [&]{
+
+                while( !stop )
+                {
+                    boost::weakable_epoch_guard g;
+
+                    for( int i = 0; i < N; ++i )
+                    {
+                        if( X * x = ws[ i ].try_get() )
+                        {
+                            if( x->v != i ) ++bad;
+                        }
+                    }
+
+                    for( int i = 0; i < N; ++i )
+                    {
+                        if( auto l = ws[ i ].lock() )
+                        {
+                            if( l->v != i ) ++bad;
+                        }
+                    }
+                }
+            });
+        }
+
+        std::thread killer( [&]{
+
+            for( int i = 0; i < N; ++i )
+            {
+                owners[ i ].reset();
+                std::this_thread::yield();
+            }
+        });
+
+        killer.join();
+        stop = true;
+
+        for( auto & t: readers )
+        {
+            t.join();
+        }
+
+        boost::weakable_epoch_barrier();
+
+        for( int i = 0; i < N; ++i )
+        {
+            BOOST_TEST( ws[ i ].expired() );
+        }
+
+        BOOST_TEST_EQ( bad.load(), 0 );
+        BOOST_TEST_EQ( live.load(), 0 );
+    }
+
+    {
+        boost::weakable_unique_ptr<X, std::default_delete<X>, IE> p( new X( 4 ) );
+        boost::unique_weak_ptr<X, IE> w( p );
+
+        {
+            auto l = w.lock();
+            BOOST_TEST_EQ( l->v, 4 );
+        }
+
+        p.reset();
+        BOOST_TEST( w.expired() );
+
+        boost::weakable_epoch_barrier();
+        BOOST_TEST_EQ( live.load(), 0 );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,209 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+static int deleted = 0;
+
+struct B
+{
+    int v = 1;
+    virtual ~B() {}
+};
+
+struct D: B
+{
+    std::string s = "x";
+};
+
+// destroys in place, the storage belongs to the pool
+struct Pool
+{
+    std::vector<D*> freed;
+
+    void operator()( D * p )
+    {
+        ++deleted;
+        p->~D();
+        freed.push_back( p );
+    }
+};
+
+// too big to be stored in place of a pointer
+struct Big
+{
+    char buf[ 64 ];
+
+    void operator()( B * p ) const
+    {
+        ++deleted;
+        delete p;
+    }
+};
+
+struct S: boost::enable_weakable_from_this<S>
+{
+    int v = 2;
+};
+
+typedef boost::weakable_unique_ptr<B, boost::weakable_erased_deleter> H;
+
+// an allocator with no memory
+template<class T>
+struct Failing
+{
+    typedef T value_type;
+
+    Failing() noexcept
+    {
+    }
+
+    template<class Y>
+    Failing( const Failing<Y>& ) noexcept
+    {
+    }
+
+    T * allocate( std::size_t )
+    {
+        throw std::bad_alloc();
+    }
+
+    void deallocate( T *, std::size_t ) noexcept
+    {
+    }
+
+    template<class Y>
+    bool operator==( const Failing<Y>& ) const noexcept
+    {
+        return true;
+    }
+
+    template<class Y>
+    bool operator!=( const Failing<Y>& ) const noexcept
+    {
+        return false;
+    }
+};
+
+struct FP: boost::weakable_single_threaded
+{
+    typedef Failing<void> allocator_type;
+};
+
+int main()
+{
+    BOOST_TEST_EQ( sizeof( H ), 2 * sizeof( void* ) );
+
+    {
+        alignas( D ) static unsigned char storage[ sizeof( D ) ];
+
+        std::vector<H> hs;
+        Pool pool;
+
+        hs.emplace_back( ::new( static_cast<void*>( storage ) ) D, std::ref( pool ) );
+        hs.emplace_back( new D, Big() );
+        hs.emplace_back( boost::make_weakable_unique<D>() );
+        hs.emplace_back( std::unique_ptr<D>( new D ) );
+
+        {
+            std::unique_ptr<D, Big> u( new D );
+            hs.emplace_back( std::move( u ) );
+
+            BOOST_TEST( !u );
+        }
+
+        std::vector< boost::unique_weak_ptr<B> > ws;
+
+        for( auto & h: hs )
+        {
+            ws.emplace_back( h );
+        }
+
+        for( auto & w: ws )
+        {
+            BOOST_TEST_EQ( w.try_get()->v, 1 );
+        }
+
+        H moved( std::move( hs[ 1 ] ) );
+        hs[ 1 ] = std::move( moved );
+
+        hs.clear();
+
+        BOOST_TEST_EQ( deleted, 3 );
+        BOOST_TEST_EQ( pool.freed.size(), 1u );
+
+        for( auto & w: ws )
+        {
+            BOOST_TEST( w.expired() );
+        }
+    }
+
+    {
+        boost::weakable_unique_ptr<D, boost::weakable_erased_deleter> d( new D, std::default_delete<D>() );
+        H h( std::move( d ) );
+        boost::unique_weak_ptr<B> w( h );
+
+        h.reset();
+        BOOST_TEST( w.expired() );
+    }
+
+    {
+        boost::weakable_unique_ptr<B, boost::weakable_erased_deleter, boost::weakable_compact<boost::weakable_multi_threaded>> c( new D, std::default_delete<D>() );
+        BOOST_TEST_EQ( c->v, 1 );
+    }
+
+    {
+        boost::weakable_unique_ptr<S, boost::weakable_erased_deleter> s( new S, std::default_delete<S>() );
+        auto w = s->weak_from_this();
+
+        BOOST_TEST_EQ( w.try_get()->v, 2 );
+
+        s.reset();
+        BOOST_TEST( w.expired() );
+    }
+
+    {
+        H h( new D, Big() );
+        std::shared_ptr<B> sp = std::move( h );
+
+        BOOST_TEST_EQ( sp->v, 1 );
+    }
+
+    {
+        H h( static_cast<D*>( 0 ), Big() );
+        BOOST_TEST( !h );
+    }
+
+    // the deleter of a unique_ptr is kept in a block allocated by the
+    // assignment, which is left undone if that throws
+    {
+        std::unique_ptr<D> u( new D );
+        boost::weakable_unique_ptr<B, boost::weakable_erased_deleter, FP> e;
+
+        BOOST_TEST( !noexcept( e = std::move( u ) ) );
+
+        try
+        {
+            e = std::move( u );
+            BOOST_ERROR( "the assignment did not throw" );
+        }
+        catch( const std::bad_alloc& )
+        {
+        }
+
+        BOOST_TEST( u );
+        BOOST_TEST( !e );
+
+        boost::weakable_unique_ptr<B> p;
+        BOOST_TEST( noexcept( p = std::move( u ) ) );
+    }
+
+    return boost::report_errors();
+}
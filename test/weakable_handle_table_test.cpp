@@ -0,0 +1,109 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_handle_table.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <type_traits>
+
+static int live = 0;
+
+struct X
+{
+    int v = 1;
+
+    X()
+    {
+        ++live;
+    }
+
+    ~X()
+    {
+        --live;
+    }
+};
+
+typedef boost::weakable_generational<> G;
+
+struct World
+{
+    static boost::weakable_slot_table & table()
+    {
+        static boost::weakable_slot_table t;
+        return t;
+    }
+};
+
+typedef boost::weakable_generational<World> GW;
+
+typedef boost::unique_weak_ptr<X, G> W;
+
+int main()
+{
+    BOOST_TEST( std::is_trivially_copyable<W>::value );
+
+    {
+        boost::unique_weak_ptr<X, G> e;
+
+        BOOST_TEST( e.expired() );
+        BOOST_TEST( !e.try_get() );
+    }
+
+    {
+        boost::weakable_unique_ptr<X, std::default_delete<X>, G> p( new X );
+        boost::unique_weak_ptr<X, G> w( p ), w2( p );
+
+        BOOST_TEST( w.try_get() == p.get() );
+        BOOST_TEST( w2.try_get() == p.get() );
+
+        boost::unique_weak_ptr<const X, G> wc( w );
+        BOOST_TEST_EQ( wc.try_get()->v, 1 );
+
+        auto q = std::move( p );
+        BOOST_TEST( w.try_get() == q.get() );
+
+        boost::weakable_unique_ptr<const X, std::default_delete<const X>, G> cq( std::move( q ) );
+        BOOST_TEST( w.try_get() == cq.get() );
+
+        cq.reset();
+
+        BOOST_TEST( w.expired() );
+        BOOST_TEST( wc.expired() );
+        BOOST_TEST_EQ( live, 0 );
+
+        // the slot is reused, the old generation stays expired
+        boost::weakable_unique_ptr<X, std::default_delete<X>, G> r( new X );
+        boost::unique_weak_ptr<X, G> wr( r );
+
+        BOOST_TEST( !w.try_get() );
+        BOOST_TEST( wr.try_get() == r.get() );
+
+        X * raw = r.release();
+        BOOST_TEST( wr.expired() );
+
+        delete raw;
+    }
+
+    {
+        boost::weakable_unique_ptr<X, std::default_delete<X>, GW> p( new X );
+        boost::unique_weak_ptr<X, GW> w;
+
+        w = p;
+
+        BOOST_TEST( w.try_get() == p.get() );
+        BOOST_TEST_EQ( World::table().size(), 1u );
+    }
+
+    {
+        std::unique_ptr<X> u( new X );
+        boost::weakable_unique_ptr<X, std::default_delete<X>, G> p( std::move( u ) );
+
+        BOOST_TEST( p );
+        BOOST_TEST( !u );
+    }
+
+    BOOST_TEST_EQ( live, 0 );
+
+    return boost::report_errors();
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_instrumented.hpp"
+#include "weakable_epoch.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <thread>
+#include <vector>
+
+typedef boost::weakable_instrumented<> I;
+typedef boost::weakable_instrumented<boost::weakable_multi_threaded> IM;
+typedef boost::weakable_instrumented<boost::weakable_epoch> IE;
+
+int main()
+{
+    {
+        boost::weakable_stats s = boost::weakable_stats_snapshot();
+
+        BOOST_TEST_EQ( s.blocks_allocated, 0u );
+        BOOST_TEST_EQ( s.live_blocks(), 0u );
+    }
+
+    {
+        boost::weakable_unique_ptr<int, std::default_delete<int>, I> p( new int( 1 ) );
+        boost::unique_weak_ptr<int, I> w( p );
+
+        boost::weakable_stats s = boost::weakable_stats_snapshot();
+
+        BOOST_TEST_EQ( s.blocks_allocated, 1u );
+        BOOST_TEST_EQ( s.live_blocks(), 1u );
+        BOOST_TEST_EQ( s.peak_live_blocks, 1u );
+
+        p.reset();
+        s = boost::weakable_stats_snapshot();
+
+        BOOST_TEST_EQ( s.live_zombie_blocks, 1u );
+        BOOST_TEST_EQ( s.live_blocks(), 1u );
+
+        BOOST_TEST( !w.try_get() );
+        BOOST_TEST( !w.try_get() );
+
+        s = boost::weakable_stats_snapshot();
+        BOOST_TEST_EQ( s.expired_try_gets, 2u );
+    }
+
+    {
+        boost::weakable_stats s = boost::weakable_stats_snapshot();
+
+        BOOST_TEST_EQ( s.live_blocks(), 0u );
+        BOOST_TEST_EQ( s.live_zombie_blocks, 0u );
+
+        unsigned long long n = 0;
+
+        for( std::size_t i = 0; i < boost::weakable_stats::zombie_buckets; ++i )
+        {
+            n += s.zombie_lifetime[ i ];
+        }
+
+        BOOST_TEST_EQ( n, 1u );
+    }
+
+    // a block freed before the expiry is not a zombie
+    {
+        boost::weakable_unique_ptr<int, std::default_delete<int>, I> p( new int( 1 ) );
+        boost::unique_weak_ptr<int, I> w( p );
+
+        w.reset();
+    }
+
+    {
+        boost::weakable_stats s = boost::weakable_stats_snapshot();
+
+        BOOST_TEST_EQ( s.blocks_allocated, 2u );
+        BOOST_TEST_EQ( s.blocks_freed, 2u );
+        BOOST_TEST_EQ( s.live_zombie_blocks, 0u );
+    }
+
+    {
+        auto q = boost::make_weakable_unique<int, IM>( 3 );
+        std::vector< boost::unique_weak_ptr<int, IM> > ws( 8, boost::unique_weak_ptr<int, IM>( q ) );
+        std::vector<std::thread> ts;
+
+        for( auto & w: ws )
+        {
+            ts.emplace_back( [&w]{
+
+                for( int i = 0; i < 1000; ++i )
+                {
+                    w.try_get();
+                }
+
+                w.reset();
+            });
+        }
+
+        q.reset();
+
+        for( auto & t: ts )
+        {
+            t.join();
+        }
+    }
+
+    {
+        boost::weakable_unique_ptr<int, std::default_delete<int>, IE> p( new int( 1 ) );
+        boost::unique_weak_ptr<int, IE> w( p );
+
+        p.reset();
+        w.reset();
+
+        boost::weakable_epoch_barrier();
+    }
+
+    {
+        boost::weakable_stats s = boost::weakable_stats_snapshot();
+
+        BOOST_TEST_EQ( s.live_blocks(), 0u );
+        BOOST_TEST_EQ( s.live_zombie_blocks, 0u );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+typedef boost::weakable_multi_threaded MT;
+
+static std::atomic<int> live( 0 );
+
+struct X
+{
+    int v = 7;
+
+    X()
+    {
+        ++live;
+    }
+
+    ~X()
+    {
+        --live;
+    }
+};
+
+int main()
+{
+    // readers lock while the owner goes away
+    for( int i = 0; i < 100; ++i )
+    {
+        boost::weakable_unique_ptr<X, std::default_delete<X>, MT> p( new X );
+        boost::unique_weak_ptr<X, MT> w( p );
+
+        std::atomic<long> sum( 0 );
+        std::atomic<int> bad( 0 );
+        std::vector<std::thread> ts;
+
+        for( int j = 0; j < 4; ++j )
+        {
+            ts.emplace_back( [w, &sum, &bad]{
+
+                for( int k = 0; k < 1000; ++k )
+                {
+                    auto l = w.lock();
+
+                    if( !l )
+                    {
+                        break;
+                    }
+
+                    if( l->v != 7 )
+                    {
+                        ++bad;
+                    }
+
+                    sum += l->v;
+                }
+            });
+        }
+
+        p.reset();
+
+        for( auto & t: ts )
+        {
+            t.join();
+        }
+
+        BOOST_TEST_EQ( bad.load(), 0 );
+        BOOST_TEST( w.expired() );
+        BOOST_TEST( !w.lock() );
+    }
+
+    BOOST_TEST_EQ( live.load(), 0 );
+
+    {
+        auto m = boost::make_weakable_unique<int, MT>( 5 );
+        boost::unique_weak_ptr<int, MT> w( m );
+
+        auto l = w.lock();
+
+        BOOST_TEST( l );
+        BOOST_TEST_EQ( *l, 5 );
+    }
+
+    // the owner waits for a lock that outlives its observer
+    for( int i = 0; i < 50; ++i )
+    {
+        auto p = new boost::weakable_unique_ptr<X, std::default_delete<X>, MT>( new X );
+
+        std::atomic<bool> pinned( false ), done( false );
+        std::atomic<int> bad( 0 );
+
+        std::thread t( [&]{
+
+            boost::unique_weak_ptr<X, MT> w( *p );
+
+            auto l = w.lock();
+            w.reset();
+
+            pinned = true;
+
+            for( int k = 0; k < 200; ++k )
+            {
+                if( live != 1 )
+                {
+                    ++bad;
+                }
+
+                std::this_thread::yield();
+            }
+
+            done = true;
+        });
+
+        while( !pinned )
+        {
+            std::this_thread::yield();
+        }
+
+        delete p;
+
+        BOOST_TEST( done );
+
+        t.join();
+
+        BOOST_TEST_EQ( bad.load(), 0 );
+    }
+
+    BOOST_TEST_EQ( live.load(), 0 );
+
+    // a single-threaded lock does not keep the block, which may go first
+    {
+        boost::weakable_unique_ptr<X> p( new X );
+        boost::unique_weak_ptr<X> w( p );
+
+        auto l = w.lock();
+        BOOST_TEST_EQ( l->v, 7 );
+
+        w.reset();
+        p.reset();
+    }
+
+    BOOST_TEST_EQ( live.load(), 0 );
+
+    return boost::report_errors();
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// make_weakable_unique with weakable_pooled comes from the pool.
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+static long allocs = 0;
+
+void * operator new( std::size_t n )
+{
+    ++allocs;
+
+    if( void * p = std::malloc( n ? n : 1 ) )
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void * p ) noexcept
+{
+    std::free( p );
+}
+
+void operator delete( void * p, std::size_t ) noexcept
+{
+    std::free( p );
+}
+
+struct X
+{
+    long a, b, c;
+};
+
+typedef boost::weakable_pooled<> P;
+
+int main()
+{
+    BOOST_TEST( sizeof( boost::detail::weakable_unique_ptr_inplace_block<X, boost::weakable_pool_allocator<X>, P> ) <= 64 );
+
+    {
+        std::vector< boost::unique_weak_ptr<X, P> > ws;
+        ws.reserve( 100 );
+
+        for( int r = 0; r < 3; ++r )
+        {
+            long a = allocs;
+
+            for( int i = 0; i < 100; ++i )
+            {
+                auto p = boost::make_weakable_unique<X, P>();
+                ws.emplace_back( p );
+                p->a = i;
+            }
+
+            for( auto & w: ws )
+            {
+                BOOST_TEST( w.expired() );
+            }
+
+            ws.clear();
+
+            // the blocks of the first round are reused
+            if( r > 0 )
+            {
+                BOOST_TEST_EQ( allocs, a );
+            }
+        }
+    }
+
+    {
+        auto a = boost::make_weakable_unique<long[], boost::weakable_pooled<boost::weakable_multi_threaded>>( 3 );
+        BOOST_TEST_EQ( a[ 2 ], 0 );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_handle_table.hpp"
+#include <boost/container/vector.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <string>
+#include <vector>
+
+struct D
+{
+    std::string s;
+
+    void operator()( int * p ) const
+    {
+        delete p;
+    }
+};
+
+typedef boost::weakable_unique_ptr<int, D> P;
+
+int main()
+{
+    BOOST_TEST( boost::has_trivial_destructor_after_move< boost::weakable_unique_ptr<int> >::value );
+    BOOST_TEST( boost::has_trivial_destructor_after_move< boost::unique_weak_ptr<int> >::value );
+    BOOST_TEST( !boost::has_trivial_destructor_after_move<P>::value );
+
+    {
+        boost::container::vector< boost::weakable_unique_ptr<int> > v;
+        std::vector< boost::unique_weak_ptr<int> > w;
+
+        for( int i = 0; i < 1000; ++i )
+        {
+            v.emplace_back( new int( i ) );
+            w.emplace_back( v.back() );
+        }
+
+        for( int i = 0; i < 1000; ++i )
+        {
+            BOOST_TEST_EQ( *w[ i ].try_get(), i );
+        }
+
+        v.erase( v.begin() );
+
+        BOOST_TEST( w[ 0 ].expired() );
+        BOOST_TEST_EQ( *w[ 1 ].try_get(), 1 );
+    }
+
+    return boost::report_errors();
+}
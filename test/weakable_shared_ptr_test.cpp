@@ -0,0 +1,165 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/smart_ptr/weak_ptr.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+static int live = 0;
+
+struct X
+{
+    int v = 1;
+
+    X()
+    {
+        ++live;
+    }
+
+    ~X()
+    {
+        --live;
+    }
+};
+
+struct E: boost::enable_weakable_from_this<E>
+{
+    E()
+    {
+        ++live;
+    }
+
+    ~E()
+    {
+        --live;
+    }
+};
+
+typedef boost::weakable_compact<> C;
+
+int main()
+{
+    {
+        boost::weakable_unique_ptr<X> p( new X );
+        boost::shared_ptr<X> s = std::move( p );
+
+        BOOST_TEST( !p );
+        BOOST_TEST_EQ( s->v, 1 );
+
+        s.reset();
+        BOOST_TEST_EQ( live, 0 );
+    }
+
+    // the observers see the object until the last shared_ptr goes away
+    {
+        boost::weakable_unique_ptr<X> p( new X );
+        boost::unique_weak_ptr<X> w( p );
+
+        std::shared_ptr<X> s = std::move( p );
+
+        BOOST_TEST( !p );
+        BOOST_TEST( w.try_get() == s.get() );
+
+        std::weak_ptr<X> ws( s );
+        s.reset();
+
+        BOOST_TEST_EQ( live, 0 );
+        BOOST_TEST( w.expired() );
+        BOOST_TEST( ws.expired() );
+    }
+
+    {
+        auto p = boost::make_weakable_unique<X>();
+        boost::shared_ptr<X> s = std::move( p );
+        boost::weak_ptr<X> ws( s );
+        boost::shared_ptr<X> s2 = s;
+
+        s.reset();
+        BOOST_TEST_EQ( live, 1 );
+
+        s2.reset();
+        BOOST_TEST_EQ( live, 0 );
+    }
+
+    {
+        auto p = boost::make_weakable_unique<X>();
+        boost::unique_weak_ptr<X> w( p );
+        std::shared_ptr<X> s = std::move( p );
+
+        BOOST_TEST_EQ( w.lock()->v, 1 );
+
+        s.reset();
+
+        BOOST_TEST( w.expired() );
+        BOOST_TEST_EQ( live, 0 );
+    }
+
+    {
+        auto p = boost::make_weakable_unique<E>();
+        auto w = p->weak_from_this();
+        std::shared_ptr<E> s = std::move( p );
+
+        BOOST_TEST( w.try_get() == s.get() );
+
+        s.reset();
+
+        BOOST_TEST( w.expired() );
+        BOOST_TEST_EQ( live, 0 );
+    }
+
+    {
+        boost::weakable_unique_ptr<E> p( new E );
+        auto w = p->weak_from_this();
+        std::shared_ptr<E> s = std::move( p );
+
+        BOOST_TEST( w.try_get() == s.get() );
+
+        s.reset();
+
+        BOOST_TEST( w.expired() );
+        BOOST_TEST_EQ( live, 0 );
+    }
+
+    {
+        boost::weakable_unique_ptr<X, std::default_delete<X>, C> p( new X );
+        boost::unique_weak_ptr<X, C> w( p );
+        boost::shared_ptr<X> s = std::move( p );
+
+        BOOST_TEST( w.try_get() == s.get() );
+
+        s.reset();
+
+        BOOST_TEST( w.expired() );
+        BOOST_TEST_EQ( live, 0 );
+    }
+
+    {
+        auto p = boost::make_weakable_unique<X[]>( 3 );
+        boost::unique_weak_ptr<X[]> w( p );
+        boost::shared_ptr<X[]> s = std::move( p );
+
+        BOOST_TEST_EQ( w.try_get().size(), 3u );
+        BOOST_TEST( &s[ 1 ] == &w.try_get()[ 1 ] );
+
+        s.reset();
+
+        BOOST_TEST_EQ( live, 0 );
+        BOOST_TEST( w.expired() );
+    }
+
+    {
+        boost::weakable_unique_ptr<X> p;
+        boost::shared_ptr<X> s = std::move( p );
+
+        BOOST_TEST( !s );
+
+        boost::weakable_unique_ptr<X, boost::weakable_inplace_deleter> q;
+        std::shared_ptr<X> s2 = std::move( q );
+
+        BOOST_TEST( !s2 );
+    }
+
+    return boost::report_errors();
+}
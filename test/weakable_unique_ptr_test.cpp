@@ -0,0 +1,225 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weakable_unique_ptr.hpp"
+#include <boost/core/lightweight_test.hpp>
+#include <string>
+
+static int live = 0;
+
+struct X
+{
+    std::string s;
+
+    explicit X( std::string s_ = "x" ): s( s_ )
+    {
+        ++live;
+    }
+
+    ~X()
+    {
+        --live;
+    }
+};
+
+struct B
+{
+    std::string s;
+
+    explicit B( std::string s_ ): s( s_ )
+    {
+        ++live;
+    }
+
+    virtual ~B()
+    {
+        --live;
+    }
+};
+
+struct C: B
+{
+    explicit C( std::string s_ ): B( s_ )
+    {
+    }
+};
+
+struct D
+{
+    int tag;
+
+    void operator()( int * p ) const
+    {
+        delete p;
+    }
+};
+
+int main()
+{
+    {
+        boost::weakable_unique_ptr<int> p( new int( 3 ) );
+        boost::unique_weak_ptr<int> w( p );
+
+        BOOST_TEST( w.try_get() == p.get() );
+        BOOST_TEST( !w.expired() );
+
+        p.reset();
+
+        BOOST_TEST( w.expired() );
+        BOOST_TEST( w.try_get() == 0 );
+    }
+
+    {
+        boost::weakable_unique_ptr<int> e;
+        boost::unique_weak_ptr<int> we( e );
+
+        BOOST_TEST( we.expired() );
+
+        boost::weakable_unique_ptr<int> p( new int( 3 ) );
+        boost::unique_weak_ptr<int> w1( p ), w2( p );
+
+        BOOST_TEST( w1.try_get() == p.get() );
+        BOOST_TEST( w2.try_get() == p.get() );
+
+        boost::weakable_unique_ptr<int> q( std::move( p ) );
+
+        BOOST_TEST( !p );
+        BOOST_TEST( w1.try_get() == q.get() );
+
+        q.reset();
+
+        BOOST_TEST( w1.expired() );
+        BOOST_TEST( w2.expired() );
+    }
+
+    {
+        boost::unique_weak_ptr<X> w;
+
+        {
+            boost::weakable_unique_ptr<X, boost::weakable_inplace_deleter> p = boost::make_weakable_unique<X>( "abc" );
+
+            BOOST_TEST_EQ( p->s, std::string( "abc" ) );
+            BOOST_TEST_EQ( live, 1 );
+
+            w = p;
+            BOOST_TEST( w.try_get() == p.get() );
+
+            p = nullptr;
+
+            BOOST_TEST_EQ( live, 0 );
+            BOOST_TEST( w.expired() );
+        }
+
+        {
+            auto p = boost::allocate_weakable_unique<X>( std::allocator<char>(), "y" );
+
+            w = p;
+            BOOST_TEST_EQ( w.try_get()->s, std::string( "y" ) );
+        }
+
+        BOOST_TEST_EQ( live, 0 );
+        BOOST_TEST( w.expired() );
+    }
+
+    // a stateless deleter takes no space
+    {
+        BOOST_TEST_EQ( sizeof( boost::weakable_unique_ptr<int> ), 2 * sizeof( void* ) );
+        BOOST_TEST_EQ( sizeof( boost::weakable_unique_ptr<int, D> ), 3 * sizeof( void* ) );
+
+        boost::weakable_unique_ptr<int, D> p( new int( 1 ), D{ 5 } );
+        BOOST_TEST_EQ( p.get_deleter().tag, 5 );
+
+        boost::weakable_unique_ptr<int, D> q( std::move( p ) );
+        BOOST_TEST_EQ( q.get_deleter().tag, 5 );
+
+        q.swap( p );
+
+        BOOST_TEST( p );
+        BOOST_TEST( !q );
+    }
+
+    {
+        boost::weakable_unique_ptr<X> p( new X );
+        boost::unique_weak_ptr<X> w( p );
+
+        X * r = p.release();
+
+        BOOST_TEST( !p );
+        BOOST_TEST( w.expired() );
+
+        delete r;
+        BOOST_TEST_EQ( live, 0 );
+    }
+
+    // assignment and reset keep the deleter of this until they take
+    // the one of r, and survive a self move
+    {
+        typedef boost::weakable_unique_ptr<int, D> P;
+
+        D d1 = { 1 }, d2 = { 2 };
+        P p( new int( 1 ), d1 ), q( new int( 2 ), d2 );
+
+        p.reset();
+        BOOST_TEST( !p );
+        BOOST_TEST_EQ( p.get_deleter().tag, 1 );
+
+        p.reset( new int( 3 ) );
+        BOOST_TEST_EQ( p.get_deleter().tag, 1 );
+
+        boost::unique_weak_ptr<int> w( q );
+
+        p = std::move( q );
+        BOOST_TEST_EQ( *p, 2 );
+        BOOST_TEST_EQ( p.get_deleter().tag, 2 );
+        BOOST_TEST( !q );
+        BOOST_TEST( w.try_get() == p.get() );
+
+        P & r = p;
+        p = std::move( r );
+        BOOST_TEST_EQ( *p, 2 );
+
+        p = nullptr;
+        BOOST_TEST( w.expired() );
+    }
+
+    // the converting assignments take the object and its block in place
+    {
+        boost::weakable_unique_ptr<B> p( new B( "p" ) );
+        boost::unique_weak_ptr<B> wp( p );
+
+        boost::weakable_unique_ptr<C> q( new C( "q" ) );
+        boost::unique_weak_ptr<C> wq( q );
+
+        p = std::move( q );
+        BOOST_TEST( wp.expired() );
+        BOOST_TEST( !q );
+        BOOST_TEST_EQ( p->s, std::string( "q" ) );
+        BOOST_TEST( wq.try_get() == p.get() );
+        BOOST_TEST_EQ( live, 1 );
+
+        boost::unique_weak_ptr<B> w2;
+
+        w2 = wq;
+        BOOST_TEST( w2.try_get() == p.get() );
+
+        w2 = std::move( wq );
+        BOOST_TEST( w2.try_get() == p.get() );
+        BOOST_TEST( wq.expired() );
+
+        p = std::unique_ptr<C>( new C( "u" ) );
+        BOOST_TEST( w2.expired() );
+        BOOST_TEST_EQ( p->s, std::string( "u" ) );
+        BOOST_TEST_EQ( live, 1 );
+
+        boost::unique_weak_ptr<B> wu( p );
+
+        p = std::unique_ptr<C>();
+        BOOST_TEST( wu.expired() );
+        BOOST_TEST( !p );
+        BOOST_TEST_EQ( live, 0 );
+    }
+
+    return boost::report_errors();
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "weak_observer_list.hpp"
+#include "weak_key_map.hpp"
+#include "weakable_handle_table.hpp"
+#include <boost/core/lightweight_test.hpp>
+
+struct S: boost::enable_weakable_from_this<S>
+{
+    int v = 1;
+};
+
+typedef boost::weakable_multi_threaded MT;
+typedef boost::weakable_compact<MT> CMT;
+
+int main()
+{
+    {
+        boost::weakable_unique_ptr<int> p( new int( 1 ) );
+
+        BOOST_TEST_EQ( p.weak_count(), 0 );
+        BOOST_TEST( !p.is_observed() );
+
+        boost::unique_weak_ptr<int> w( p );
+
+        BOOST_TEST_EQ( p.weak_count(), 1 );
+        BOOST_TEST( p.is_observed() );
+
+        {
+            boost::unique_weak_ptr<int> w2( w );
+            BOOST_TEST_EQ( p.weak_count(), 2 );
+        }
+
+        w.reset();
+        BOOST_TEST( !p.is_observed() );
+    }
+
+    {
+        auto p = boost::make_weakable_unique<int>( 3 );
+        boost::unique_weak_ptr<int> w( p );
+
+        w.reset();
+        BOOST_TEST( !p.is_observed() );
+
+        w = p;
+        p.reset();
+        BOOST_TEST( w.expired() );
+    }
+
+    {
+        boost::weakable_unique_ptr<int, std::default_delete<int>, CMT> p( new int( 2 ) );
+        BOOST_TEST( !p.is_observed() );
+
+        boost::unique_weak_ptr<int, CMT> w( p );
+        BOOST_TEST_EQ( p.weak_count(), 1 );
+    }
+
+    {
+        boost::weakable_unique_ptr<S> p( new S );
+        BOOST_TEST( !p.is_observed() );
+
+        auto w = p->weak_from_this();
+        BOOST_TEST_EQ( p.weak_count(), 1 );
+
+        w.reset();
+        BOOST_TEST( !p.is_observed() );
+
+        auto m = boost::make_weakable_unique<S>();
+        BOOST_TEST( !m.is_observed() );
+    }
+
+    {
+        auto p = boost::make_weakable_unique<int[]>( 4 );
+        boost::unique_weak_ptr<int[]> w( p );
+
+        BOOST_TEST( p.is_observed() );
+    }
+
+    // the containers of observers count
+    {
+        boost::weakable_unique_ptr<int, std::default_delete<int>, MT> p( new int( 1 ) );
+        boost::weak_observer_list<int, MT> l;
+
+        l.push_back( boost::unique_weak_ptr<int, MT>( p ) );
+        BOOST_TEST_EQ( p.weak_count(), 1 );
+    }
+
+    {
+        typedef boost::weakable_generational<> G;
+
+        boost::weakable_unique_ptr<int, std::default_delete<int>, G> p( new int( 1 ) );
+        BOOST_TEST( !p.is_observed() );
+
+        boost::unique_weak_ptr<int, G> w( p );
+        BOOST_TEST( p.is_observed() );
+    }
+
+    return boost::report_errors();
+}
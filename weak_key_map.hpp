@@ -0,0 +1,321 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SMART_PTR_WEAK_KEY_MAP_HPP_INCLUDED
+#define BOOST_SMART_PTR_WEAK_KEY_MAP_HPP_INCLUDED
+
+#include "weakable_unique_ptr.hpp"
+
+#include <cstdint>
+#include <memory>
+
+namespace boost {
+
+// A flat hash map keyed by the identity of observed objects, for data kept
+// on the side of objects that one does not own. An entry references the
+// control block of its key, so the address of the block, and with it the
+// key, can not be reused while the entry is in the map; lookups never see
+// an entry whose object has expired. Expired entries are purged a few at a
+// time by each insertion, and all at once by purge().
+//
+// Open addressing with linear probing, and backward shift on erasure so
+// that there are no tombstones.
+template<class K, class V, class Policy = weakable_single_threaded>
+class weak_key_map
+{
+public:
+
+    typedef unique_weak_ptr<K, Policy> key_type;
+    typedef V mapped_type;
+
+private:
+
+    typedef boost::detail::weakable_unique_ptr_control_block<Policy> control_block;
+
+    // entries are moved by erasures and by rehashing
+    static_assert( std::is_nothrow_move_constructible<V>::value, "The mapped type must be nothrow move constructible" );
+
+    // slots looked at for expired entries by each insertion
+    static const std::size_t purge_step = 2;
+    static const std::size_t min_capacity = 16;
+
+    struct slot
+    {
+        control_block * pc; // 0 for an empty slot
+        typename std::aligned_storage<sizeof( V ), std::alignment_of<V>::value>::type storage;
+
+        V * value() noexcept
+        {
+            return static_cast<V*>( static_cast<void*>( &storage ) );
+        }
+    };
+
+    std::unique_ptr<slot[]> slots;
+    std::size_t mask; // capacity - 1, the capacity is a power of two
+    std::size_t count;
+    std::size_t cursor; // where the next insertion purges
+
+    static std::size_t bucket( control_block * pc, std::size_t mask ) noexcept
+    {
+        std::uint64_t h = reinterpret_cast<std::uintptr_t>( pc );
+        h *= 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>( h >> 32 ) & mask;
+    }
+
+    static bool expired( control_block * pc ) noexcept
+    {
+        return pc->get() == nullptr;
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return slots ? mask + 1 : 0;
+    }
+
+    // the slot of pc, or the empty slot that ends its probe sequence
+    std::size_t probe( control_block * pc ) const noexcept
+    {
+        std::size_t i = bucket( pc, mask );
+
+        while( slots[ i ].pc && slots[ i ].pc != pc )
+        {
+            i = ( i + 1 ) & mask;
+        }
+        return i;
+    }
+
+    void destroy( slot & s ) noexcept
+    {
+        s.value()->~V();
+        intrusive_ptr_release( s.pc );
+        s.pc = 0;
+    }
+
+    void erase_at( std::size_t i ) noexcept
+    {
+        destroy( slots[ i ] );
+        --count;
+
+        // moves back the entries that probed past i
+        for( std::size_t j = ( i + 1 ) & mask; slots[ j ].pc; j = ( j + 1 ) & mask )
+        {
+            std::size_t k = bucket( slots[ j ].pc, mask );
+
+            if( i <= j ? ( i < k && k <= j ) : ( i < k || k <= j ) )
+            {
+                continue;
+            }
+
+            ::new( static_cast<void*>( &slots[ i ].storage ) ) V( std::move( *slots[ j ].value() ) );
+            slots[ j ].value()->~V();
+            slots[ i ].pc = slots[ j ].pc;
+            slots[ j ].pc = 0;
+            i = j;
+        }
+    }
+
+    void purge_some() noexcept
+    {
+        for( std::size_t n = 0; n < purge_step; ++n )
+        {
+            cursor = ( cursor + 1 ) & mask;
+
+            if( slots[ cursor ].pc && expired( slots[ cursor ].pc ) )
+            {
+                erase_at( cursor );
+            }
+        }
+    }
+
+    void rehash( std::size_t n )
+    {
+        std::unique_ptr<slot[]> old( new slot[ n ] );
+        std::size_t old_capacity = capacity();
+
+        for( std::size_t i = 0; i < n; ++i )
+        {
+            old[ i ].pc = 0;
+        }
+
+        // old takes the slots that are being rehashed
+        old.swap( slots );
+        mask = n - 1;
+        cursor = 0;
+
+        for( std::size_t i = 0; i < old_capacity; ++i )
+        {
+            slot & s = old[ i ];
+
+            if( s.pc == 0 )
+            {
+                continue;
+            }
+
+            if( expired( s.pc ) )
+            {
+                destroy( s );
+                --count;
+                continue;
+            }
+
+            slot & t = slots[ probe( s.pc ) ];
+            ::new( static_cast<void*>( &t.storage ) ) V( std::move( *s.value() ) );
+            s.value()->~V();
+            t.pc = s.pc;
+        }
+    }
+
+public:
+
+    weak_key_map() noexcept : slots(), mask( 0 ), count( 0 ), cursor( 0 )
+    {
+    }
+
+    weak_key_map( weak_key_map&& r ) noexcept
+        : slots( std::move( r.slots ) ), mask( r.mask ), count( r.count ), cursor( r.cursor )
+    {
+        r.mask = 0;
+        r.count = 0;
+        r.cursor = 0;
+    }
+
+    weak_key_map& operator=( weak_key_map&& r ) noexcept
+    {
+        weak_key_map( std::move( r ) ).swap( *this );
+        return *this;
+    }
+
+    weak_key_map( const weak_key_map& ) = delete;
+    weak_key_map& operator=( const weak_key_map& ) = delete;
+
+    ~weak_key_map() noexcept
+    {
+        clear();
+    }
+
+    // entries whose key has expired and that are not purged yet are counted
+    std::size_t size() const noexcept
+    {
+        return count;
+    }
+
+    bool empty() const noexcept
+    {
+        return count == 0;
+    }
+
+    // the value of k, constructed from args if k is not in the map yet;
+    // { 0, false } if k has expired
+    template<class... Args>
+    std::pair<V*, bool> try_emplace( const key_type& k, Args&&... args )
+    {
+        if( k.expired() )
+        {
+            return std::pair<V*, bool>( static_cast<V*>( 0 ), false );
+        }
+
+        if( slots )
+        {
+            purge_some();
+        }
+
+        // at most three quarters full
+        if( ( count + 1 ) * 4 > capacity() * 3 )
+        {
+            rehash( capacity() ? capacity() * 2 : min_capacity );
+        }
+
+        control_block * pc = k.pc;
+        slot & s = slots[ probe( pc ) ];
+
+        if( s.pc )
+        {
+            return std::pair<V*, bool>( s.value(), false );
+        }
+
+        ::new( static_cast<void*>( &s.storage ) ) V( std::forward<Args>( args )... );
+        intrusive_ptr_add_ref( pc );
+        s.pc = pc;
+        ++count;
+
+        return std::pair<V*, bool>( s.value(), true );
+    }
+
+    // 0 if k is not in the map or has expired
+    V * find( const key_type& k ) const noexcept
+    {
+        control_block * pc = k.pc;
+
+        if( !slots || !pc || expired( pc ) )
+        {
+            return 0;
+        }
+
+        slot & s = slots[ probe( pc ) ];
+        return s.pc ? s.value() : 0;
+    }
+
+    bool erase( const key_type& k ) noexcept
+    {
+        control_block * pc = k.pc;
+
+        if( !slots || !pc )
+        {
+            return false;
+        }
+
+        std::size_t i = probe( pc );
+
+        if( !slots[ i ].pc )
+        {
+            return false;
+        }
+
+        erase_at( i );
+        return true;
+    }
+
+    // removes every entry whose key has expired
+    void purge() noexcept
+    {
+        for( std::size_t i = 0; i < capacity(); )
+        {
+            // erase_at may move the next entry into i
+            if( slots[ i ].pc && expired( slots[ i ].pc ) )
+            {
+                erase_at( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    void clear() noexcept
+    {
+        for( std::size_t i = 0; i < capacity(); ++i )
+        {
+            if( slots[ i ].pc )
+            {
+                destroy( slots[ i ] );
+            }
+        }
+
+        count = 0;
+    }
+
+    void swap( weak_key_map& r ) noexcept
+    {
+        slots.swap( r.slots );
+        std::swap( mask, r.mask );
+        std::swap( count, r.count );
+        std::swap( cursor, r.cursor );
+    }
+};
+
+}
+
+#endif  // #ifndef BOOST_SMART_PTR_WEAK_KEY_MAP_HPP_INCLUDED
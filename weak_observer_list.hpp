@@ -0,0 +1,202 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SMART_PTR_WEAK_OBSERVER_LIST_HPP_INCLUDED
+#define BOOST_SMART_PTR_WEAK_OBSERVER_LIST_HPP_INCLUDED
+
+#include "weakable_unique_ptr.hpp"
+
+#include <vector>
+
+namespace boost {
+
+// A list of unique_weak_ptrs that is walked as a whole, as in a registry
+// of listeners. The control blocks and the pointers are kept in two packed
+// arrays; the walk reads the pointers in order and prefetches the blocks
+// ahead, and nothing is counted per entry. Expired entries are skipped and
+// removed once they make up half of the list.
+template<class T, class Policy = weakable_single_threaded>
+class weak_observer_list
+{
+public:
+
+    typedef typename boost::detail::sp_element<T>::type element_type;
+    typedef Policy policy_type;
+
+private:
+
+    static_assert( !std::is_array<T>::value, "Arrays are not supported" );
+
+    typedef boost::detail::weakable_unique_ptr_control_block<Policy> control_block;
+
+    // how many entries ahead the walk prefetches the block
+    static const std::size_t prefetch_distance = 8;
+
+    // each block is referenced once by the list
+    std::vector<control_block*> pcs;
+    std::vector<element_type*> pxs;
+
+    // unpins when f returns or throws
+    struct pin_guard
+    {
+        control_block * pc;
+
+        ~pin_guard() noexcept
+        {
+            pc->unpin();
+        }
+    };
+
+public:
+
+    weak_observer_list() noexcept
+    {
+    }
+
+    weak_observer_list( weak_observer_list&& r ) noexcept
+        : pcs( std::move( r.pcs ) ), pxs( std::move( r.pxs ) )
+    {
+        r.pcs.clear();
+        r.pxs.clear();
+    }
+
+    weak_observer_list& operator=( weak_observer_list&& r ) noexcept
+    {
+        weak_observer_list( std::move( r ) ).swap( *this );
+        return *this;
+    }
+
+    weak_observer_list( const weak_observer_list& ) = delete;
+    weak_observer_list& operator=( const weak_observer_list& ) = delete;
+
+    ~weak_observer_list() noexcept
+    {
+        clear();
+    }
+
+    // an expired w is not added
+    void push_back( const unique_weak_ptr<T, Policy>& w )
+    {
+        if( w.expired() )
+        {
+            return;
+        }
+
+        // both arrays grow together and geometrically, before anything
+        // changes, so that the push_backs below cannot throw
+        std::size_t n = pcs.size();
+
+        if( n == pcs.capacity() || n == pxs.capacity() )
+        {
+            std::size_t c = n < 8? 16: 2 * n;
+
+            pcs.reserve( c );
+            pxs.reserve( c );
+        }
+
+        control_block * pc = w.pc;
+        intrusive_ptr_add_ref( pc );
+
+        pcs.push_back( pc );
+        pxs.push_back( w.px );
+    }
+
+    // entries that have expired and are not removed yet are counted
+    std::size_t size() const noexcept
+    {
+        return pcs.size();
+    }
+
+    bool empty() const noexcept
+    {
+        return pcs.empty();
+    }
+
+    // Calls f( element_type& ) for each live object, in the order of
+    // insertion; f must not modify the list. With weakable_multi_threaded
+    // each object is pinned during its call, as by unique_weak_ptr::lock().
+    template<class F>
+    void for_each_alive( F f )
+    {
+        std::size_t n = pcs.size();
+        std::size_t d = 0;
+
+        for( std::size_t i = 0; i < n; ++i )
+        {
+            if( i + prefetch_distance < n )
+            {
+                boost::detail::wup_prefetch( pcs[ i + prefetch_distance ] );
+            }
+
+            control_block * pc = pcs[ i ];
+
+            if( pc->pin() )
+            {
+                pin_guard g = { pc };
+                f( *pxs[ i ] );
+            }
+            else
+            {
+                ++d;
+            }
+        }
+
+        if( d * 2 > n )
+        {
+            compact();
+        }
+    }
+
+    // removes the expired entries now, keeping the order of the others
+    void compact() noexcept
+    {
+        std::size_t n = pcs.size();
+        std::size_t j = 0;
+
+        for( std::size_t i = 0; i < n; ++i )
+        {
+            if( pcs[ i ]->get() )
+            {
+                pcs[ j ] = pcs[ i ];
+                pxs[ j ] = pxs[ i ];
+                ++j;
+            }
+            else
+            {
+                intrusive_ptr_release( pcs[ i ] );
+            }
+        }
+
+        pcs.resize( j );
+        pxs.resize( j );
+    }
+
+    void clear() noexcept
+    {
+        for( std::size_t i = 0; i < pcs.size(); ++i )
+        {
+            intrusive_ptr_release( pcs[ i ] );
+        }
+
+        pcs.clear();
+        pxs.clear();
+    }
+
+    void swap( weak_observer_list& r ) noexcept
+    {
+        pcs.swap( r.pcs );
+        pxs.swap( r.pxs );
+    }
+};
+
+template<class T, class Policy>
+inline void swap( weak_observer_list<T, Policy>& a, weak_observer_list<T, Policy>& b ) noexcept
+{
+    a.swap( b );
+}
+
+}
+
+#endif  // #ifndef BOOST_SMART_PTR_WEAK_OBSERVER_LIST_HPP_INCLUDED
@@ -0,0 +1,450 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SMART_PTR_WEAKABLE_EPOCH_HPP_INCLUDED
+#define BOOST_SMART_PTR_WEAKABLE_EPOCH_HPP_INCLUDED
+
+// Epoch based reclamation for weakable_unique_ptr. A reader announces the
+// epoch it reads in, in a slot of its own thread, instead of pinning the
+// control block, so readers of one popular object do not write to a shared
+// cache line. The owner expires the observers and retires the object to
+// its thread; a retired object is destroyed once the epoch has advanced
+// twice, that is once every reader that may have seen it has left.
+
+#include "weakable_unique_ptr.hpp"
+
+#include <atomic>
+#include <new>
+
+namespace boost {
+
+namespace detail {
+
+// An object waiting for its readers to leave.
+struct wup_retired
+{
+    wup_retired * next;
+    unsigned long epoch;
+    void ( *reclaim )( wup_retired * r );
+
+    explicit wup_retired( void ( *f )( wup_retired * r ) ) noexcept
+        : next( 0 ), epoch( 0 ), reclaim( f )
+    {
+    }
+};
+
+// The slot of a reading thread. Slots are never freed, a thread that
+// exits leaves its slot to the next one.
+struct wup_epoch_record
+{
+    std::atomic<unsigned long> active; // the epoch read in, 0 outside
+    std::atomic<bool> used;
+    wup_epoch_record * next;
+
+    wup_epoch_record() noexcept : active( 0 ), used( true ), next( 0 )
+    {
+    }
+};
+
+class wup_epoch
+{
+    struct domain
+    {
+        std::atomic<unsigned long> epoch;
+        std::atomic<wup_epoch_record*> records;
+
+        constexpr domain() noexcept : epoch( 1 ), records( nullptr )
+        {
+        }
+    };
+
+    // the retired objects of the thread, oldest first
+    struct local
+    {
+        wup_epoch_record * r;
+        unsigned depth;
+        wup_retired * head;
+        wup_retired * tail;
+        std::size_t count;
+        std::size_t next_scan;
+        bool scanning;
+        bool reaped;
+    };
+
+    // retirements between two attempts to reclaim
+    static const std::size_t scan_batch = 64;
+
+    struct reaper
+    {
+        ~reaper() noexcept
+        {
+            local & l = get_local();
+
+            // objects retired from now on are destroyed right away
+            l.reaped = true;
+
+            synchronize();
+
+            while( wup_retired * n = l.head )
+            {
+                l.head = n->next;
+                n->reclaim( n );
+            }
+
+            l.tail = 0;
+            l.count = 0;
+
+            if( l.r )
+            {
+                l.r->active.store( 0, std::memory_order_release );
+                l.r->used.store( false, std::memory_order_release );
+                l.r = 0;
+            }
+        }
+    };
+
+    static domain & get_domain() noexcept
+    {
+        static domain d;
+        return d;
+    }
+
+    static local & get_local() noexcept
+    {
+        static thread_local local l = { 0, 0, 0, 0, 0, scan_batch, false, false };
+        return l;
+    }
+
+    static void watch_exit( local & l ) noexcept
+    {
+        if( !l.reaped )
+        {
+            static thread_local reaper r;
+            ( void )r;
+        }
+    }
+
+    static wup_epoch_record * attach( local & l ) noexcept
+    {
+        domain & d = get_domain();
+        wup_epoch_record * r = d.records.load( std::memory_order_acquire );
+
+        for( ; r; r = r->next )
+        {
+            bool f = false;
+
+            if( !r->used.load( std::memory_order_relaxed ) && r->used.compare_exchange_strong( f, true, std::memory_order_acquire ) )
+            {
+                break;
+            }
+        }
+
+        if( !r )
+        {
+            r = new wup_epoch_record;
+            r->next = d.records.load( std::memory_order_relaxed );
+
+            while( !d.records.compare_exchange_weak( r->next, r, std::memory_order_release, std::memory_order_relaxed ) )
+            {
+            }
+        }
+
+        l.r = r;
+        watch_exit( l );
+
+        return r;
+    }
+
+    // the epoch after one attempt to advance it; it advances when every
+    // reader has announced the current one
+    static unsigned long try_advance() noexcept
+    {
+        domain & d = get_domain();
+        unsigned long e = d.epoch.load( std::memory_order_seq_cst );
+
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+
+        for( wup_epoch_record * r = d.records.load( std::memory_order_acquire ); r; r = r->next )
+        {
+            unsigned long a = r->active.load( std::memory_order_seq_cst );
+
+            if( a != 0 && a != e )
+            {
+                return e;
+            }
+        }
+
+        if( d.epoch.compare_exchange_strong( e, e + 1, std::memory_order_seq_cst ) )
+        {
+            return e + 1;
+        }
+
+        return e;
+    }
+
+    // an object destroyed from here may retire others, they join the tail
+    static void scan( local & l ) noexcept
+    {
+        if( l.scanning )
+        {
+            return;
+        }
+
+        l.scanning = true;
+
+        unsigned long e = try_advance();
+
+        while( l.head && l.head->epoch + 2 <= e )
+        {
+            wup_retired * n = l.head;
+
+            l.head = n->next;
+
+            if( !l.head )
+            {
+                l.tail = 0;
+            }
+
+            --l.count;
+            n->reclaim( n );
+        }
+
+        l.next_scan = l.count + scan_batch;
+        l.scanning = false;
+    }
+
+public:
+
+    static void enter() noexcept
+    {
+        local & l = get_local();
+
+        if( l.depth++ == 0 )
+        {
+            wup_epoch_record * r = l.r ? l.r : attach( l );
+
+            r->active.store( get_domain().epoch.load( std::memory_order_seq_cst ), std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+        }
+    }
+
+    static void leave() noexcept
+    {
+        local & l = get_local();
+
+        if( --l.depth == 0 )
+        {
+            l.r->active.store( 0, std::memory_order_release );
+        }
+    }
+
+    // Waits for the readers that are in now to leave; the thread itself
+    // must not be reading.
+    static void synchronize() noexcept
+    {
+        unsigned long t = get_domain().epoch.load( std::memory_order_seq_cst );
+
+        for( unsigned k = 0; try_advance() < t + 2; ++k )
+        {
+            boost::detail::yield( k );
+        }
+    }
+
+    static void retire( wup_retired * n ) noexcept
+    {
+        local & l = get_local();
+
+        if( l.reaped )
+        {
+            synchronize();
+            n->reclaim( n );
+            return;
+        }
+
+        watch_exit( l );
+
+        n->epoch = get_domain().epoch.load( std::memory_order_seq_cst );
+
+        if( l.tail )
+        {
+            l.tail->next = n;
+        }
+        else
+        {
+            l.head = n;
+        }
+
+        l.tail = n;
+
+        if( ++l.count >= l.next_scan )
+        {
+            scan( l );
+        }
+    }
+
+    // destroys the objects retired by this thread
+    static void barrier() noexcept
+    {
+        synchronize();
+        scan( get_local() );
+    }
+};
+
+// A retired object with its deleter; the block is kept for an object
+// that lives in its storage.
+template<class L, class D, class T, class C>
+class wup_retired_object
+    : public wup_retired
+    , boost::empty_value<D>
+{
+    T * p;
+    intrusive_ptr<C> pc;
+
+    static void destroy( wup_retired * r )
+    {
+        wup_retired_object * q = static_cast<wup_retired_object*>( r );
+
+        L::dispose( q->boost::empty_value<D>::get(), q->p, q->pc.get() );
+        delete q;
+    }
+
+public:
+
+    wup_retired_object( D&& d, T * p_, C * pc_ ) noexcept
+        : wup_retired( &destroy )
+        , boost::empty_value<D>( boost::empty_init_t(), std::move( d ) )
+        , p( p_ ), pc( pc_ )
+    {
+    }
+};
+
+// A reader pins the object with a store to the slot of its thread and a
+// load; the owner expires the observers with one store and no wait.
+class wup_state_epoch: public wup_state_mt
+{
+public:
+
+    // the epoch is entered on the thread of the reader; the wrappers of
+    // the state, such as that of weakable_instrumented, inherit this
+    typedef std::true_type thread_bound_pin;
+
+    explicit wup_state_epoch( void* p ) noexcept
+        : wup_state_mt( p )
+    {
+    }
+
+    // readers are not counted
+    bool exclusive() const noexcept
+    {
+        return false;
+    }
+
+    void * pin() noexcept
+    {
+        wup_epoch::enter();
+
+        void * p = get();
+
+        if( p == nullptr )
+        {
+            wup_epoch::leave();
+        }
+
+        return p;
+    }
+
+    void unpin() noexcept
+    {
+        wup_epoch::leave();
+    }
+
+    void expire() noexcept
+    {
+        wup_state_mt::reset();
+    }
+
+    // an object that leaves its owner alive waits for its readers
+    void reset() noexcept
+    {
+        if( get() )
+        {
+            expire();
+            wup_epoch::synchronize();
+        }
+    }
+
+    // the object is destroyed when its readers are gone, or right away
+    // if there is no memory to keep it
+    template<class L, class D, class T, class C>
+    static void retire( D&& d, T * p, C * pc ) noexcept
+    {
+        typedef wup_retired_object<L, typename std::remove_reference<D>::type, T, C> node;
+
+        node * n = ::new( std::nothrow ) node( std::move( d ), p, pc );
+
+        if( !n )
+        {
+            wup_epoch::synchronize();
+            L::dispose( d, p, pc );
+            return;
+        }
+
+        wup_epoch::retire( n );
+    }
+};
+
+} // namespace detail
+
+// Observers may be used by other threads than the owner, and readers are
+// guarded by epochs: unique_weak_ptr::lock() writes only to memory of its
+// own thread, and try_get() may be used for as long as a
+// weakable_epoch_guard lives on the thread. The owner does not wait for
+// its readers, the object is destroyed by a later destruction of an owner
+// on the same thread, after every reader that may have seen it has left.
+//
+// release(), and the conversions to shared_ptr, wait for the readers
+// instead; like the owner of a pinned object, they must not be called by
+// a thread that is reading. A unique_weak_lock must be destroyed on the
+// thread that took it, and does not move.
+struct weakable_epoch
+{
+    typedef boost::detail::wup_state_epoch state;
+
+    typedef std::false_type compact_layout;
+
+    typedef std::true_type deferred_reclamation;
+
+    typedef std::allocator<void> allocator_type;
+};
+
+// Marks the thread as reading weakable_epoch objects; guards nest.
+class weakable_epoch_guard
+{
+public:
+
+    weakable_epoch_guard() noexcept
+    {
+        boost::detail::wup_epoch::enter();
+    }
+
+    ~weakable_epoch_guard() noexcept
+    {
+        boost::detail::wup_epoch::leave();
+    }
+
+    weakable_epoch_guard( const weakable_epoch_guard& ) = delete;
+    weakable_epoch_guard& operator=( const weakable_epoch_guard& ) = delete;
+};
+
+// Waits for the readers and destroys the objects retired by this thread,
+// which must not be reading.
+inline void weakable_epoch_barrier() noexcept
+{
+    boost::detail::wup_epoch::barrier();
+}
+
+}
+
+#endif  // #ifndef BOOST_SMART_PTR_WEAKABLE_EPOCH_HPP_INCLUDED
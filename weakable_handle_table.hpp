@@ -0,0 +1,431 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SMART_PTR_WEAKABLE_HANDLE_TABLE_HPP_INCLUDED
+#define BOOST_SMART_PTR_WEAKABLE_HANDLE_TABLE_HPP_INCLUDED
+
+// A backend of weakable_unique_ptr without control blocks. The owner
+// registers its object in a slot of a table, and unique_weak_ptr is the
+// index of the slot and its generation, 64 bits that are copied without
+// touching a count. The slot gets a new generation when the owner lets go
+// of the object, which expires the observers, and is then reused.
+//
+// The table is not synchronized: owners and observers of one table must
+// be used by one thread at a time. As an observer does not keep its slot,
+// the pointer can not be adjusted for a base class; owners and observers
+// only convert to a more cv-qualified T.
+
+#include "weakable_unique_ptr.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace boost {
+
+class weakable_slot_table
+{
+    struct slot
+    {
+        void * px;
+        std::uint32_t gen;
+        std::uint32_t next; // the next free slot
+    };
+
+    // slot 0 is never handed out, so that { 0, 0 } is the null handle
+    std::vector<slot> slots;
+    std::uint32_t free_head;
+
+public:
+
+    weakable_slot_table(): slots( 1, slot{ 0, 1, 0 } ), free_head( 0 )
+    {
+    }
+
+    weakable_slot_table( const weakable_slot_table& ) = delete;
+    weakable_slot_table& operator=( const weakable_slot_table& ) = delete;
+
+    std::uint32_t acquire( void* p )
+    {
+        std::uint32_t i = free_head;
+
+        if( i != 0 )
+        {
+            free_head = slots[ i ].next;
+        }
+        else
+        {
+            i = static_cast<std::uint32_t>( slots.size() );
+            slots.push_back( slot{ 0, 1, 0 } );
+        }
+
+        slots[ i ].px = p;
+        return i;
+    }
+
+    // expires the observers of slot i
+    void release( std::uint32_t i ) noexcept
+    {
+        slot & s = slots[ i ];
+
+        s.px = 0;
+
+        // generation 0 is left to the null handle
+        if( ++s.gen == 0 )
+        {
+            s.gen = 1;
+        }
+
+        s.next = free_head;
+        free_head = i;
+    }
+
+    std::uint32_t generation( std::uint32_t i ) const noexcept
+    {
+        return slots[ i ].gen;
+    }
+
+    void * get( std::uint32_t i, std::uint32_t gen ) const noexcept
+    {
+        slot const & s = slots[ i ];
+        return s.gen == gen ? s.px : 0;
+    }
+
+    // the registered objects and the free slots
+    std::size_t size() const noexcept
+    {
+        return slots.size() - 1;
+    }
+};
+
+// The table of weakable_generational<>, one per thread. An owner must die
+// before the thread that registered its object exits.
+struct weakable_thread_slots
+{
+    static weakable_slot_table& table() noexcept
+    {
+        static thread_local weakable_slot_table t;
+        return t;
+    }
+};
+
+// Slots::table() returns the table of the objects, for example the table
+// of one simulation world.
+template<class Slots = weakable_thread_slots>
+struct weakable_generational
+{
+    typedef Slots slots_type;
+};
+
+namespace detail {
+
+template<class Y, class T>
+struct wup_same_object: std::is_same<typename std::remove_cv<Y>::type, typename std::remove_cv<T>::type>
+{
+};
+
+template<class Slots>
+struct wup_has_blocks< weakable_generational<Slots> >: std::false_type
+{
+};
+}
+
+template<class T, class Deleter, class Slots>
+class BOOST_WUP_RELOCATABLE_IF( std::is_trivially_copyable<Deleter>::value ) weakable_unique_ptr<T, Deleter, weakable_generational<Slots>> BOOST_WUP_RELOCATABLE_IF_ELIGIBLE
+    : boost::empty_value<Deleter>
+{
+public:
+
+    static_assert( !std::is_array<T>::value, "Arrays are not supported by weakable_generational" );
+
+    typedef Deleter deleter_type;
+    typedef weakable_generational<Slots> policy_type;
+    typedef T element_type;
+    typedef element_type* pointer;
+
+private:
+
+    static const std::uint32_t npos = std::uint32_t( -1 );
+
+    T * px;
+
+    // the slot is taken by the first unique_weak_ptr, with the same thread
+    // safety rules as the lazy control block of weakable_unique_ptr
+    mutable std::uint32_t index;
+
+    template<class Y, class E, class P> friend class weakable_unique_ptr;
+    template<class Y, class P> friend class unique_weak_ptr;
+
+    Deleter& deleter() noexcept
+    {
+        return boost::empty_value<Deleter>::get();
+    }
+
+    std::uint32_t acquire_slot() const
+    {
+        if( index == npos && px )
+        {
+            index = Slots::table().acquire( const_cast<void*>( static_cast<const volatile void*>( px ) ) );
+        }
+        return index;
+    }
+
+    void release_slot() noexcept
+    {
+        if( index != npos )
+        {
+            Slots::table().release( index );
+            index = npos;
+        }
+    }
+
+public:
+
+    ~weakable_unique_ptr() noexcept
+    {
+        release_slot();
+
+        if( px )
+        {
+            deleter()( px );
+        }
+    }
+
+    constexpr weakable_unique_ptr() noexcept
+        : boost::empty_value<Deleter>( ), px( 0 ), index( npos )
+    {
+    }
+
+    constexpr weakable_unique_ptr( std::nullptr_t ) noexcept
+        : boost::empty_value<Deleter>( ), px( 0 ), index( npos )
+    {
+    }
+
+    explicit weakable_unique_ptr( pointer p ) noexcept
+        : boost::empty_value<Deleter>( ), px( p ), index( npos )
+    {
+    }
+
+    weakable_unique_ptr( pointer p, const Deleter& d ) noexcept
+        : boost::empty_value<Deleter>( boost::empty_init_t(), d ), px( p ), index( npos )
+    {
+    }
+
+    weakable_unique_ptr( weakable_unique_ptr && r ) noexcept
+        : boost::empty_value<Deleter>( boost::empty_init_t(), std::move( r.deleter() ) ), px( r.px ), index( r.index )
+    {
+        r.px = 0;
+        r.index = npos;
+    }
+
+    template<class Y, class E> weakable_unique_ptr( weakable_unique_ptr<Y, E, policy_type> && r,
+        typename std::enable_if<boost::detail::wup_same_object<Y, T>::value && std::is_convertible<Y*, T*>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty(),
+        typename std::enable_if<std::is_convertible<E, Deleter>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() ) noexcept
+        : boost::empty_value<Deleter>( boost::empty_init_t(), std::move( r.deleter() ) ), px( r.px ), index( r.index )
+    {
+        r.px = 0;
+        r.index = npos;
+    }
+
+    template<class Y, class E>
+    weakable_unique_ptr( std::unique_ptr<Y, E> && r,
+        typename std::enable_if<boost::detail::wup_same_object<Y, T>::value && std::is_convertible<Y*, T*>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty(),
+        typename std::enable_if<std::is_convertible<E, Deleter>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() ) noexcept
+        : boost::empty_value<Deleter>( boost::empty_init_t(), std::forward<E>( r.get_deleter() ) ), px( r.release() ), index( npos )
+    {
+    }
+
+    weakable_unique_ptr( weakable_unique_ptr const & r ) = delete;
+
+    weakable_unique_ptr & operator=( weakable_unique_ptr && r ) noexcept
+    {
+        weakable_unique_ptr( std::move( r ) ).swap( *this );
+        return *this;
+    }
+
+    template<class Y, class E>
+    weakable_unique_ptr & operator=( weakable_unique_ptr<Y, E, policy_type> && r ) noexcept
+    {
+        weakable_unique_ptr( std::move( r ) ).swap( *this );
+        return *this;
+    }
+
+    weakable_unique_ptr & operator=( std::nullptr_t ) noexcept
+    {
+        weakable_unique_ptr().swap( *this );
+        return *this;
+    }
+
+    weakable_unique_ptr & operator=( weakable_unique_ptr const & r ) = delete;
+
+    // the observers expire
+    pointer release() noexcept
+    {
+        release_slot();
+        return boost::exchange( px, nullptr );
+    }
+
+    void reset() noexcept
+    {
+        weakable_unique_ptr().swap( *this );
+    }
+
+    void reset( pointer p ) noexcept
+    {
+        weakable_unique_ptr( p ).swap( *this );
+    }
+
+    typename boost::detail::sp_dereference< T >::type operator* () const noexcept
+    {
+        return *px;
+    }
+
+    typename boost::detail::sp_member_access< T >::type operator-> () const noexcept
+    {
+        return px;
+    }
+
+    element_type * get() const noexcept
+    {
+        return px;
+    }
+
+    // the observers are not counted: true once one has taken a slot
+    bool is_observed() const noexcept
+    {
+        return index != npos;
+    }
+
+    Deleter& get_deleter() noexcept
+    {
+        return boost::empty_value<Deleter>::get();
+    }
+
+    const Deleter& get_deleter() const noexcept
+    {
+        return boost::empty_value<Deleter>::get();
+    }
+
+    explicit operator bool () const noexcept
+    {
+        return px != 0;
+    }
+
+    void swap( weakable_unique_ptr & r ) noexcept
+    {
+        std::swap( deleter(), r.deleter() );
+        std::swap( px, r.px );
+        std::swap( index, r.index );
+    }
+};
+
+template<class T, class Slots>
+class BOOST_WUP_RELOCATABLE_IF( true ) unique_weak_ptr<T, weakable_generational<Slots>> BOOST_WUP_RELOCATABLE_IF_ELIGIBLE
+{
+public:
+
+    typedef T element_type;
+    typedef weakable_generational<Slots> policy_type;
+
+private:
+
+    std::uint32_t index;
+    std::uint32_t gen;
+
+    template<class Y, class P> friend class unique_weak_ptr;
+
+public:
+
+    constexpr unique_weak_ptr() noexcept : index( 0 ), gen( 0 )
+    {
+    }
+
+    template<class Y>
+    constexpr unique_weak_ptr( const unique_weak_ptr<Y, policy_type>& r,
+        typename std::enable_if<boost::detail::wup_same_object<Y, T>::value && std::is_convertible<Y*, T*>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() ) noexcept
+        : index( r.index ), gen( r.gen )
+    {
+    }
+
+    // takes a slot for the object of r if it does not have one yet
+    template<class Y, class E>
+    unique_weak_ptr( const weakable_unique_ptr<Y, E, policy_type>& r,
+        typename std::enable_if<boost::detail::wup_same_object<Y, T>::value && std::is_convertible<Y*, T*>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() )
+        : index( 0 ), gen( 0 )
+    {
+        if( r )
+        {
+            index = r.acquire_slot();
+            gen = Slots::table().generation( index );
+        }
+    }
+
+    template<class Y, class E>
+    unique_weak_ptr& operator=( const weakable_unique_ptr<Y, E, policy_type>& r )
+    {
+        unique_weak_ptr( r ).swap( *this );
+        return *this;
+    }
+
+    BOOST_CXX14_CONSTEXPR void reset() noexcept
+    {
+        index = 0;
+        gen = 0;
+    }
+
+    BOOST_CXX14_CONSTEXPR void swap( unique_weak_ptr& r ) noexcept
+    {
+        boost::detail::wup_swap( index, r.index );
+        boost::detail::wup_swap( gen, r.gen );
+    }
+
+    // one load of the slot and a compare of its generation
+    bool expired() const noexcept
+    {
+        return Slots::table().get( index, gen ) == 0;
+    }
+
+    element_type * try_get() const noexcept
+    {
+        return static_cast<element_type*>( Slots::table().get( index, gen ) );
+    }
+
+    // the identity of the object is its slot and generation
+
+    template<class Y>
+    constexpr bool owner_before( const unique_weak_ptr<Y, policy_type>& r ) const noexcept
+    {
+        return index < r.index || ( index == r.index && gen < r.gen );
+    }
+
+    template<class Y>
+    constexpr bool owner_equals( const unique_weak_ptr<Y, policy_type>& r ) const noexcept
+    {
+        return index == r.index && gen == r.gen;
+    }
+
+    std::size_t owner_hash_value() const noexcept
+    {
+        return std::hash<std::uint64_t>()( std::uint64_t( index ) << 32 | gen );
+    }
+
+    template<class Y>
+    constexpr bool operator==( const unique_weak_ptr<Y, policy_type>& r ) const noexcept
+    {
+        return owner_equals( r );
+    }
+
+    template<class Y>
+    constexpr bool operator!=( const unique_weak_ptr<Y, policy_type>& r ) const noexcept
+    {
+        return !owner_equals( r );
+    }
+};
+
+static_assert( sizeof( unique_weak_ptr<int, weakable_generational<>> ) == 8,
+    "unique_weak_ptr with weakable_generational must be an index and a generation" );
+
+}
+
+#endif  // #ifndef BOOST_SMART_PTR_WEAKABLE_HANDLE_TABLE_HPP_INCLUDED
@@ -0,0 +1,201 @@
+// Copyright (c) 2025 Denis Mikhailov
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SMART_PTR_WEAKABLE_INSTRUMENTED_HPP_INCLUDED
+#define BOOST_SMART_PTR_WEAKABLE_INSTRUMENTED_HPP_INCLUDED
+
+// Counters of the control blocks of weakable_instrumented policies, for
+// finding observers that keep the blocks of dead objects alive. A block
+// whose object has expired while observers still hold it is a zombie; the
+// time from the expiry to the free of the block is its lifetime. Other
+// policies pay nothing.
+
+#include "weakable_unique_ptr.hpp"
+
+#include <atomic>
+#include <chrono>
+
+namespace boost {
+
+// A copy of the counters, each read on its own.
+struct weakable_stats
+{
+    // bucket i counts the zombies that lived less than 10^i microseconds,
+    // and not less than 10^(i-1); the last bucket counts the rest
+    static const std::size_t zombie_buckets = 11;
+
+    unsigned long long blocks_allocated;
+    unsigned long long blocks_freed;
+    unsigned long long peak_live_blocks;
+
+    // the zombies that are not freed yet
+    unsigned long long live_zombie_blocks;
+
+    // calls of unique_weak_ptr::try_get() on an expired object
+    unsigned long long expired_try_gets;
+
+    unsigned long long zombie_lifetime[ zombie_buckets ];
+    unsigned long long zombie_lifetime_ns; // the sum of the lifetimes
+
+    unsigned long long live_blocks() const noexcept
+    {
+        return blocks_allocated - blocks_freed;
+    }
+};
+
+namespace detail {
+
+// Zero initialized without a constructor, so that the counters work from
+// the constructors and destructors of other globals.
+struct wup_counters
+{
+    std::atomic<unsigned long long> allocated;
+    std::atomic<unsigned long long> freed;
+    std::atomic<unsigned long long> peak;
+    std::atomic<unsigned long long> zombies;
+    std::atomic<unsigned long long> expired_try_gets;
+    std::atomic<unsigned long long> lifetime[ weakable_stats::zombie_buckets ];
+    std::atomic<unsigned long long> lifetime_ns;
+
+    static wup_counters & get() noexcept
+    {
+        static wup_counters c;
+        return c;
+    }
+
+    void on_allocate() noexcept
+    {
+        unsigned long long n = allocated.fetch_add( 1, std::memory_order_relaxed ) + 1 - freed.load( std::memory_order_relaxed );
+        unsigned long long m = peak.load( std::memory_order_relaxed );
+
+        while( n > m && !peak.compare_exchange_weak( m, n, std::memory_order_relaxed ) )
+        {
+        }
+    }
+
+    void on_zombie_free( unsigned long long ns ) noexcept
+    {
+        std::size_t i = 0;
+
+        for( unsigned long long b = 1000; i + 1 < weakable_stats::zombie_buckets && ns >= b; b *= 10 )
+        {
+            ++i;
+        }
+
+        zombies.fetch_sub( 1, std::memory_order_relaxed );
+        lifetime[ i ].fetch_add( 1, std::memory_order_relaxed );
+        lifetime_ns.fetch_add( ns, std::memory_order_relaxed );
+    }
+};
+
+// S with the counters; the state lives as long as its block.
+template<class S>
+class wup_state_instrumented: public S
+{
+    typedef std::chrono::steady_clock clock;
+
+    // the expiry of the object, 0 while it is alive
+    clock::rep expired_at;
+
+    void on_expire() noexcept
+    {
+        if( expired_at == 0 )
+        {
+            expired_at = clock::now().time_since_epoch().count() | 1;
+            wup_counters::get().zombies.fetch_add( 1, std::memory_order_relaxed );
+        }
+    }
+
+public:
+
+    explicit wup_state_instrumented( void* p ) noexcept
+        : S( p ), expired_at( 0 )
+    {
+        wup_counters::get().on_allocate();
+    }
+
+    ~wup_state_instrumented() noexcept
+    {
+        wup_counters & c = wup_counters::get();
+
+        c.freed.fetch_add( 1, std::memory_order_relaxed );
+
+        if( expired_at != 0 )
+        {
+            clock::duration d( clock::now().time_since_epoch().count() - expired_at );
+            c.on_zombie_free( std::chrono::duration_cast<std::chrono::nanoseconds>( d ).count() );
+        }
+    }
+
+    void * peek() const noexcept
+    {
+        void * p = S::peek();
+
+        if( p == nullptr )
+        {
+            wup_counters::get().expired_try_gets.fetch_add( 1, std::memory_order_relaxed );
+        }
+
+        return p;
+    }
+
+    // the owner expires the object with its last reference
+    // to the block, or while the observers still hold it
+
+    void reset() noexcept
+    {
+        if( S::get() )
+        {
+            on_expire();
+        }
+
+        S::reset();
+    }
+
+    void expire() noexcept
+    {
+        if( S::get() )
+        {
+            on_expire();
+        }
+
+        S::expire();
+    }
+};
+
+} // namespace detail
+
+// Base with its control blocks counted.
+template<class Base = weakable_single_threaded>
+struct weakable_instrumented: Base
+{
+    typedef boost::detail::wup_state_instrumented<typename Base::state> state;
+};
+
+// The counters of all weakable_instrumented policies, for example to be
+// exported to a monitoring system.
+inline weakable_stats weakable_stats_snapshot() noexcept
+{
+    boost::detail::wup_counters & c = boost::detail::wup_counters::get();
+    weakable_stats r;
+
+    r.blocks_allocated = c.allocated.load( std::memory_order_relaxed );
+    r.blocks_freed = c.freed.load( std::memory_order_relaxed );
+    r.peak_live_blocks = c.peak.load( std::memory_order_relaxed );
+    r.live_zombie_blocks = c.zombies.load( std::memory_order_relaxed );
+    r.expired_try_gets = c.expired_try_gets.load( std::memory_order_relaxed );
+
+    for( std::size_t i = 0; i < weakable_stats::zombie_buckets; ++i )
+    {
+        r.zombie_lifetime[ i ] = c.lifetime[ i ].load( std::memory_order_relaxed );
+    }
+
+    r.zombie_lifetime_ns = c.lifetime_ns.load( std::memory_order_relaxed );
+    return r;
+}
+
+}
+
+#endif  // #ifndef BOOST_SMART_PTR_WEAKABLE_INSTRUMENTED_HPP_INCLUDED
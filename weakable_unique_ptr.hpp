@@ -6,351 +6,3236 @@
 #ifndef BOOST_SMART_PTR_WEAKABLE_UNIQUE_PTR_HPP_INCLUDED
 #define BOOST_SMART_PTR_WEAKABLE_UNIQUE_PTR_HPP_INCLUDED
 
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <type_traits>
+#include <utility>
+#include <boost/config.hpp>
 #include <boost/smart_ptr/shared_ptr.hpp>
 #include <boost/smart_ptr/intrusive_ptr.hpp>
+#include <boost/smart_ptr/detail/yield_k.hpp>
+#include <boost/core/alloc_construct.hpp>
+#include <boost/core/allocator_access.hpp>
+#include <boost/core/empty_value.hpp>
 #include <boost/core/exchange.hpp>
+#include <boost/core/pointer_traits.hpp>
+#include <boost/move/traits.hpp>
+#include <boost/align/aligned_allocator.hpp>
+
+// Owners and observers hold no pointer to themselves, so moving one is a
+// memcpy of its bytes. Where the compiler can be told so, they are marked
+// trivially relocatable, with the P1144 attribute or the P2786 keyword.
+
+#if defined( __has_cpp_attribute )
+# if __has_cpp_attribute( trivially_relocatable )
+#  define BOOST_WUP_RELOCATABLE_IF( cond ) [[trivially_relocatable( cond )]]
+# endif
+#endif
+
+#if !defined( BOOST_WUP_RELOCATABLE_IF )
+# define BOOST_WUP_RELOCATABLE_IF( cond )
+#endif
+
+#if defined( __cpp_trivial_relocatability )
+# define BOOST_WUP_RELOCATABLE_IF_ELIGIBLE trivially_relocatable_if_eligible
+#else
+# define BOOST_WUP_RELOCATABLE_IF_ELIGIBLE
+#endif
+
+// The cache line that weakable_cache_aligned lays out control blocks for.
+#if !defined( BOOST_WUP_CACHE_LINE_SIZE )
+# define BOOST_WUP_CACHE_LINE_SIZE 64
+#endif
+
+// constexpr for the destructors, which can only be with C++20
+#if defined( __cpp_constexpr_dynamic_alloc ) && __cpp_constexpr_dynamic_alloc >= 201907L
+# define BOOST_WUP_CXX20_CONSTEXPR constexpr
+#else
+# define BOOST_WUP_CXX20_CONSTEXPR
+#endif
 
 namespace boost {
-namespace detail {
 
+namespace movelib
+{
+    template<class T> struct default_delete;
+} // namespace movelib
+
+// Deleter of the objects that their control block destroys: those created
+// by make_weakable_unique and allocate_weakable_unique, which live in the
+// storage of the block, and those given with a deleter that the block
+// keeps, as shared_ptr does. Owners of objects from any allocator, pool or
+// arena are then of one type.
+struct weakable_inplace_deleter
+{
+};
+
+typedef weakable_inplace_deleter weakable_erased_deleter;
+
+// A pointer and a length, what unique_weak_ptr<T[]>::try_get() returns.
+// Empty when the array has expired.
 template<class T>
-class weakable_unique_ptr_control_block
+class weakable_span
 {
-    long ref_count;
-    T* px; // TODO: should be type erased with `void* px`
+    T * p_;
+    std::size_t n_;
+
 public:
-    explicit weakable_unique_ptr_control_block( T* p ) noexcept
-        : ref_count( 0 ), px( p )
+
+    typedef T element_type;
+    typedef T * iterator;
+
+    constexpr weakable_span() noexcept : p_( 0 ), n_( 0 )
     {
     }
 
-    weakable_unique_ptr_control_block( const weakable_unique_ptr_control_block& r ) = delete;
-    weakable_unique_ptr_control_block& operator=( const weakable_unique_ptr_control_block& r ) = delete;
+    constexpr weakable_span( T * p, std::size_t n ) noexcept : p_( p ), n_( n )
+    {
+    }
 
-    void reset() noexcept
+    constexpr T * data() const noexcept
     {
-        px = nullptr;
+        return p_;
     }
 
-    T * get() const noexcept
+    constexpr std::size_t size() const noexcept
     {
-        return px;
+        return n_;
     }
 
-    friend void intrusive_ptr_add_ref( weakable_unique_ptr_control_block *p ) {   
-        ++p->ref_count;
+    constexpr bool empty() const noexcept
+    {
+        return n_ == 0;
     }
 
-    friend void intrusive_ptr_release( weakable_unique_ptr_control_block *p ) {
-        if ( --p->ref_count == 0 ) {
-            delete p;
-        }
+    constexpr T & operator[]( std::size_t i ) const noexcept
+    {
+        return p_[ i ];
+    }
+
+    constexpr T * begin() const noexcept
+    {
+        return p_;
+    }
+
+    constexpr T * end() const noexcept
+    {
+        return p_ + n_;
+    }
+
+    explicit constexpr operator bool () const noexcept
+    {
+        return p_ != 0;
     }
 };
-}
 
+namespace detail {
+
+struct wup_internal_constructor_tag
+{
+};
+
+// std::swap, which is only constexpr from C++20
 template<class T>
-class unique_weak_ptr;
+BOOST_CXX14_CONSTEXPR void wup_swap( T& a, T& b ) noexcept
+{
+    T t( std::move( a ) );
+    a = std::move( b );
+    b = std::move( t );
+}
 
-template<class T, class Deleter = std::default_delete<T>>
-class weakable_unique_ptr
+// a hint that p is read soon, nothing where the compiler has no such hint;
+// a null p is skipped, its prefetch can cost a page walk
+inline void wup_prefetch( const void * p ) noexcept
 {
-public:
+#if defined( __GNUC__ )
+    if( p )
+    {
+        __builtin_prefetch( p );
+    }
+#else
+    ( void )p;
+#endif
+}
 
-    // TODO: implement support for arrays
-    static_assert( !std::is_array<T>::value, "Arrays are not supported" );
+// The length of the array of weakable_unique_ptr<T[]>, kept by the owner
+// and by its observers, and nothing for a single object.
 
-    // TODO: implement support for reference deleter
-    static_assert( !std::is_reference<T>::value, "Reference as deleter is not supported" );
+template<class T>
+class wup_extent
+{
+public:
 
-    typedef Deleter deleter_type;
-    typedef typename boost::detail::sp_element<T>::type element_type;
-    typedef element_type* pointer;
+    typedef T * view_type;
 
-private:
+    constexpr explicit wup_extent( std::size_t = 1 ) noexcept
+    {
+    }
 
-    typedef typename boost::detail::weakable_unique_ptr_control_block<element_type> control_block;
+    constexpr std::size_t size() const noexcept
+    {
+        return 1;
+    }
 
-    pointer px;
-    Deleter pd;                       // TODO: implement EBO
-    intrusive_ptr<control_block> pc;  // TODO: initialize it lazily??
+    static constexpr T * view( T * p ) noexcept
+    {
+        return p;
+    }
+};
 
-    friend class unique_weak_ptr<T>;
+template<class T>
+class wup_extent<T[]>
+{
+    std::size_t n;
 
 public:
 
-    // destructor
+    typedef weakable_span<T> view_type;
 
-    ~weakable_unique_ptr() noexcept
+    // 0 for an empty owner; an array is never taken without its length
+    constexpr explicit wup_extent( std::size_t n_ = 0 ) noexcept : n( n_ )
     {
-        if( px )
-        {
-            pd( px );
-        }
-        if ( pc )
-        {
-            ( *pc ).reset();
-        }
     }
 
-    // constructors
-
-    constexpr weakable_unique_ptr() noexcept
-        : px( 0 ), pd( ), pc( )
+    constexpr std::size_t size() const noexcept
     {
+        return n;
     }
 
-    constexpr weakable_unique_ptr( std::nullptr_t ) noexcept
-        : px( 0 ), pd( ), pc( )
+    constexpr view_type view( T * p ) const noexcept
     {
+        return view_type( p, p ? n : 0 );
     }
+};
+
+// Expiry hooks of a control block, an intrusive list of nodes that are
+// called and unlinked one by one when the observers expire.
+
+class wup_hook_node
+{
+    friend class wup_hook_list;
+
+    wup_hook_node * prev;
+    wup_hook_node * next;
+    bool linked;
 
-    explicit weakable_unique_ptr( pointer p )
-        : px( p ), pd( ), pc( new control_block( p ) )
+protected:
+
+    wup_hook_node() noexcept : prev( 0 ), next( 0 ), linked( false )
     {
     }
 
-    template<class D = deleter_type>
-    weakable_unique_ptr( pointer p, const D& d,
-        typename boost::detail::sp_enable_if_convertible<D, Deleter>::type = boost::detail::sp_empty() )
-        : px( p ), pd( d ), pc( new control_block( p ) )
+    ~wup_hook_node() noexcept
     {
-        boost::detail::sp_assert_convertible< D, Deleter >();
     }
 
-    template<class Y, class D = deleter_type>
-    weakable_unique_ptr( pointer p, D&& d,
-        typename boost::detail::sp_enable_if_convertible<D, Deleter>::type = boost::detail::sp_empty() )
-        : px( p ), pd( std::forward<D>(d) ), pc( new control_block( p ) )
+public:
+
+    virtual void on_expire() noexcept = 0;
+};
+
+class wup_hook_list
+{
+    wup_hook_node * head;
+
+public:
+
+    wup_hook_list() noexcept : head( 0 )
     {
-        boost::detail::sp_assert_convertible< D, Deleter >();
     }
 
-    // move constructor
+    bool empty() const noexcept
+    {
+        return head == 0;
+    }
 
-    weakable_unique_ptr( weakable_unique_ptr && r ) noexcept
-        : px( r.px ), pd( std::move( r.pd ) ), pc( std::move( r.pc ) )
+    void push( wup_hook_node * n ) noexcept
     {
-        r.px = 0;
+        n->prev = 0;
+        n->next = head;
+
+        if( head )
+        {
+            head->prev = n;
+        }
+
+        head = n;
+        n->linked = true;
     }
 
-    // converting move constructor
+    void erase( wup_hook_node * n ) noexcept
+    {
+        if( !n->linked )
+        {
+            return;
+        }
+
+        if( n->prev )
+        {
+            n->prev->next = n->next;
+        }
+        else
+        {
+            head = n->next;
+        }
 
-    template<class Y, class E> weakable_unique_ptr( weakable_unique_ptr<Y, E> && r,
-        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty(),
-        typename boost::detail::sp_enable_if_convertible<E, Deleter>::type = boost::detail::sp_empty() ) noexcept
-        : px( r.px ), pd( std::move( r.pd ) ), pc( std::move( r.pc ) )
+        if( n->next )
+        {
+            n->next->prev = n->prev;
+        }
+
+        n->linked = false;
+    }
+
+    wup_hook_node * pop() noexcept
     {
-        boost::detail::sp_assert_convertible< Y, T >();
-        boost::detail::sp_assert_convertible< E, Deleter >();
+        wup_hook_node * n = head;
 
-        r.px = 0;
+        if( n )
+        {
+            erase( n );
+        }
+        return n;
     }
+};
 
-    // copy constructor
+// State of a control block shared by one owner and its observers.
 
-    weakable_unique_ptr( weakable_unique_ptr const & r ) = delete;
+// GCC 12 follows the path where the release of the last observer frees
+// the block into the exclusive() of the owner, which holds a reference
+// of its own, so that path does not exist
+#if defined( BOOST_GCC ) && BOOST_GCC >= 120000
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wuse-after-free"
+#endif
 
-    // construction from unique_ptr
-    // TODO: implement this
+class wup_state_st
+{
+    long ref_count;
+    void* px;
 
-    // assignment
+public:
 
-    weakable_unique_ptr & operator=( weakable_unique_ptr && r ) noexcept
+    // try_borrow() needs an owner that waits for the borrower,
+    // which a single thread can not do
+    typedef std::false_type borrowing;
+
+    // pin() keeps nothing out, so a lock need not keep the block
+    typedef std::false_type pinning;
+
+    // whether a pin belongs to the thread that took it, and its
+    // lock must then be released on that thread
+    typedef std::false_type thread_bound_pin;
+
+    // whether the pointer has a line of its own, see wup_inplace_alignment
+    typedef std::false_type split;
+
+    // whether weak_expiry_hook can be linked into the block, see weakable_hooked
+    typedef std::false_type expiry_hooks;
+
+    explicit wup_state_st( void* p ) noexcept
+        : ref_count( 0 ), px( p )
     {
-        weakable_unique_ptr( std::move( r ) ).swap( *this );
-        return *this;
     }
 
-    template<class Y, class E>
-    weakable_unique_ptr & operator=( weakable_unique_ptr<Y, E> && r ) noexcept
+    void add_ref() noexcept
     {
-        weakable_unique_ptr( std::move( r ) ).swap( *this );
-        return *this;
+        ++ref_count;
     }
 
-    weakable_unique_ptr & operator=( std::nullptr_t ) noexcept
+    bool release() noexcept
     {
-        weakable_unique_ptr().swap( *this );
-        return *this;
+        return --ref_count == 0;
     }
 
-    weakable_unique_ptr & operator=( weakable_unique_ptr const & r ) = delete;
-
-    // TODO: implement assignment from unique_ptr
+    long use_count() const noexcept
+    {
+        return ref_count;
+    }
 
-    // release
-    pointer release() noexcept
+    bool exclusive() const noexcept
     {
-        weakable_unique_ptr tmp;
-        tmp.swap( *this );
-        return boost::exchange( tmp.px, nullptr );
+        return ref_count == 1;
     }
 
-    // reset
+    void * get() const noexcept
+    {
+        return px;
+    }
 
-    void reset( pointer p = pointer() ) noexcept
+    // the read of unique_weak_ptr::try_get()
+    void * peek() const noexcept
     {
-        weakable_unique_ptr( p ).swap( *this );
+        return px;
     }
 
-    // accessors
+    void set( void* p ) noexcept
+    {
+        px = p;
+    }
 
-    // TODO: must be unavailable for array version
-    typename boost::detail::sp_dereference< T >::type operator* () const noexcept
+    void reset() noexcept
     {
-        // TODO: pointer might have a throwing operator*
-        return *px;
+        px = nullptr;
     }
 
-    // TODO: must be unavailable for array version
-    typename boost::detail::sp_member_access< T >::type operator-> () const noexcept
+    // the owner lives on the same thread as the reader,
+    // so it can not die while the reader is using the object
+    void * pin() noexcept
     {
         return px;
     }
 
-    // TODO: implement operator[] for array version
-
-    element_type * get() const noexcept
+    void unpin() noexcept
     {
-        return px;
     }
+};
 
-    Deleter& get_deleter() noexcept
+#if defined( BOOST_GCC ) && BOOST_GCC >= 120000
+# pragma GCC diagnostic pop
+#endif
+
+// a count and a pointer; the hooks come with weakable_hooked
+static_assert( sizeof( wup_state_st ) == 2 * sizeof( void* ), "wup_state_st is a count and a pointer" );
+
+// The single threaded state with a list of expiry hooks, which the other
+// owners do not pay for.
+
+template<class S>
+class wup_state_hooked: public S
+{
+    wup_hook_list hooks;
+
+public:
+
+    typedef std::true_type expiry_hooks;
+
+    explicit wup_state_hooked( void* p ) noexcept
+        : S( p )
     {
-        return pd;
     }
 
-    const Deleter& get_deleter() const noexcept
+    void reset() noexcept
     {
-        return pd;
+        S::reset();
+
+        // the only cost of the hooks when there are none
+        if( !hooks.empty() )
+        {
+            while( wup_hook_node * n = hooks.pop() )
+            {
+                n->on_expire();
+            }
+        }
     }
 
-    explicit operator bool () const noexcept
+    // false if the object has expired
+    bool hook( wup_hook_node * n ) noexcept
     {
-        return px != 0;
+        if( S::get() == nullptr )
+        {
+            return false;
+        }
+
+        hooks.push( n );
+        return true;
     }
 
-    // conversions to shared_ptr
+    void unhook( wup_hook_node * n ) noexcept
+    {
+        hooks.erase( n );
+    }
+};
 
-    // TODO: implement this
+// The pointer of the state, padded by Pad bytes so that what observers
+// and readers write lands on another cache line than what they read.
 
-    // swap
+template<std::size_t Pad>
+struct wup_state_front
+{
+    std::atomic<void*> px;
+    char pad[ Pad ];
 
-    void swap( weakable_unique_ptr & r ) noexcept
+    explicit wup_state_front( void* p ) noexcept : px( p )
     {
-        std::swap( px, r.px );
-        std::swap( pd, r.pd );
-        std::swap( pc, r.pc );
     }
 };
 
-template<class T>
-class unique_weak_ptr
+template<>
+struct wup_state_front<0>
 {
-public:
+    std::atomic<void*> px;
 
-    typedef typename boost::detail::sp_element<T>::type element_type;
+    explicit wup_state_front( void* p ) noexcept : px( p )
+    {
+    }
+};
 
-private:
+// Readers pin the object with one increment and one load, both wait-free.
+// The owner clears px and then waits for the pinned readers to leave, so
+// it pays a store and a load when nobody is reading.
 
-    typedef typename boost::detail::weakable_unique_ptr_control_block<element_type> control_block;
+template<std::size_t Pad>
+class wup_state_mt_basic
+{
+    wup_state_front<Pad> front;
+    std::atomic<long> ref_count;
+    std::atomic<long> pins;
 
-    intrusive_ptr<control_block> pc;
+    // the list is guarded by a spinlock; hooked is set by the first hook
+    // and tells the owner to look at the list
+    wup_hook_list hooks;
+    std::atomic<bool> hooked;
+    std::atomic<bool> locked;
 
-public:
-    ~unique_weak_ptr()
+    // held by one borrower, which the owner waits for as for the pins
+    std::atomic<bool> borrowed;
+
+    void lock() noexcept
     {
+        for( unsigned k = 0; locked.exchange( true, std::memory_order_acquire ); ++k )
+        {
+            boost::detail::yield( k );
+        }
     }
 
-    constexpr unique_weak_ptr() noexcept : pc( )
+    void unlock() noexcept
     {
+        locked.store( false, std::memory_order_release );
     }
 
-    unique_weak_ptr( const unique_weak_ptr& r ) noexcept: pc( r.pc )
+    // a hook may unhook itself, or others, from on_expire()
+    void fire_hooks() noexcept
     {
+        lock();
+
+        while( wup_hook_node * n = hooks.pop() )
+        {
+            unlock();
+            n->on_expire();
+            lock();
+        }
+
+        unlock();
     }
 
-    template<class Y>
-    unique_weak_ptr( const unique_weak_ptr<Y>& r,
-        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty() ) noexcept
-        : pc( boost::static_pointer_cast<control_block>( r.pc ) )
+public:
+
+    typedef std::true_type borrowing;
+    typedef std::true_type pinning;
+    typedef std::false_type thread_bound_pin;
+    typedef std::integral_constant<bool, Pad != 0> split;
+    typedef std::true_type expiry_hooks;
+
+    explicit wup_state_mt_basic( void* p ) noexcept
+        : front( p ), ref_count( 0 ), pins( 0 ), hooked( false ), locked( false ), borrowed( false )
     {
-        boost::detail::sp_assert_convertible< Y, T >();
     }
 
-    template<class Y>
-    unique_weak_ptr( const weakable_unique_ptr<Y>& r,
-        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty() ) noexcept
-        : pc( boost::static_pointer_cast<control_block>( r.pc ) )
+    void add_ref() noexcept
     {
-        boost::detail::sp_assert_convertible< Y, T >();
+        ref_count.fetch_add( 1, std::memory_order_relaxed );
     }
 
-    unique_weak_ptr( unique_weak_ptr&& r ) noexcept : pc( std::move( r.pc ) )
+    bool release() noexcept
     {
+        return ref_count.fetch_sub( 1, std::memory_order_acq_rel ) == 1;
     }
 
-    template<class Y>
-    unique_weak_ptr( unique_weak_ptr<Y>&& r,
-        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty() ) noexcept
-        : pc( boost::static_pointer_cast<control_block>( std::move( r.pc ) ) )
+    // acquire, so that an observer that has just gone away
+    // is done with the block
+    long use_count() const noexcept
     {
-        boost::detail::sp_assert_convertible< Y, T >();
+        return ref_count.load( std::memory_order_acquire );
     }
 
-    unique_weak_ptr& operator=( const unique_weak_ptr& r ) noexcept
+    // a lock or a borrow may outlive the observer that it was taken from;
+    // with no observer left nobody can take one anew
+    bool exclusive() const noexcept
     {
-        unique_weak_ptr( r ).swap( *this );
-        return *this;
+        return use_count() == 1 && pins.load( std::memory_order_acquire ) == 0 && !borrowed.load( std::memory_order_acquire );
     }
 
-    template<class Y>
-    unique_weak_ptr& operator=( const unique_weak_ptr<Y>& r ) noexcept
+    void * get() const noexcept
     {
-        unique_weak_ptr( r ).swap( *this );
-        return *this;
+        return front.px.load( std::memory_order_acquire );
     }
 
-    template<class Y>
-    unique_weak_ptr& operator=( const weakable_unique_ptr<Y>& r ) noexcept
+    void * peek() const noexcept
     {
-        unique_weak_ptr( r ).swap( *this );
-        return *this;
+        return get();
     }
 
-    unique_weak_ptr& operator=( unique_weak_ptr&& r ) noexcept
+    void set( void* p ) noexcept
     {
-        unique_weak_ptr( std::move( r ) ).swap( *this );
-        return *this;
+        front.px.store( p, std::memory_order_release );
     }
 
-    template<class Y>
-    unique_weak_ptr& operator=( unique_weak_ptr<Y>&& r ) noexcept
+    void reset() noexcept
     {
-        unique_weak_ptr( std::move( r ) ).swap( *this );
-        return *this;
+        front.px.store( nullptr, std::memory_order_seq_cst );
+
+        for( unsigned k = 0; pins.load( std::memory_order_seq_cst ) != 0 || borrowed.load( std::memory_order_seq_cst ); ++k )
+        {
+            boost::detail::yield( k );
+        }
+
+        // either a hook sees px cleared, or this sees the hook
+        if( hooked.load( std::memory_order_seq_cst ) )
+        {
+            fire_hooks();
+        }
     }
 
-    void reset() noexcept
+    bool hook( wup_hook_node * n ) noexcept
     {
-        unique_weak_ptr().swap( *this );
+        lock();
+
+        hooks.push( n );
+        hooked.store( true, std::memory_order_seq_cst );
+
+        bool alive = front.px.load( std::memory_order_seq_cst ) != nullptr;
+
+        if( !alive )
+        {
+            hooks.erase( n );
+        }
+
+        unlock();
+        return alive;
     }
 
-    void swap( unique_weak_ptr& r ) noexcept
+    void unhook( wup_hook_node * n ) noexcept
     {
-        std::swap( pc, r.pc );
+        lock();
+        hooks.erase( n );
+        unlock();
     }
 
-    bool expired() const noexcept
+    void * pin() noexcept
     {
-        return !( pc && pc->get() );
+        pins.fetch_add( 1, std::memory_order_seq_cst );
+
+        void * p = front.px.load( std::memory_order_seq_cst );
+
+        if( p == nullptr )
+        {
+            pins.fetch_sub( 1, std::memory_order_release );
+        }
+
+        return p;
+    }
+
+    void unpin() noexcept
+    {
+        pins.fetch_sub( 1, std::memory_order_release );
     }
 
-    element_type * try_get() const noexcept
+    // one compare and swap, and one store to give it back
+    void * borrow() noexcept
+    {
+        bool f = false;
+
+        if( !borrowed.compare_exchange_strong( f, true, std::memory_order_seq_cst ) )
+        {
+            return nullptr;
+        }
+
+        void * p = front.px.load( std::memory_order_seq_cst );
+
+        if( p == nullptr )
+        {
+            borrowed.store( false, std::memory_order_release );
+        }
+
+        return p;
+    }
+
+    void unborrow() noexcept
+    {
+        borrowed.store( false, std::memory_order_release );
+    }
+};
+
+typedef wup_state_mt_basic<0> wup_state_mt;
+
+static_assert( BOOST_WUP_CACHE_LINE_SIZE > 2 * sizeof( void* ), "BOOST_WUP_CACHE_LINE_SIZE is too small" );
+
+// With the vtable pointer of the block, px fills the first line of a block
+// that starts on a line; the counts, the pins and the hooks take the next.
+typedef wup_state_mt_basic<BOOST_WUP_CACHE_LINE_SIZE - 2 * sizeof( void* )> wup_state_mt_split;
+
+// The states of the multi-threaded policies. As with the counts of
+// shared_ptr, they are the single-threaded one when BOOST_SP_DISABLE_THREADS
+// is defined or Boost is configured without threads.
+
+#if defined( BOOST_SP_DISABLE_THREADS ) || !defined( BOOST_HAS_THREADS )
+
+// the hooks of weakable_multi_threaded stay
+typedef wup_state_hooked<wup_state_st> wup_state_threaded;
+typedef wup_state_hooked<wup_state_st> wup_state_threaded_split;
+
+#else
+
+typedef wup_state_mt wup_state_threaded;
+typedef wup_state_mt_split wup_state_threaded_split;
+
+#endif
+
+// The alignment of an object made in place with its block. Behind a split
+// state, or a state that wraps one, the object starts on a line of its
+// own, so that writing it does not invalidate the line of the counts.
+
+template<class S, class T>
+struct wup_inplace_alignment: std::integral_constant<std::size_t,
+    ( S::split::value && std::alignment_of<T>::value < BOOST_WUP_CACHE_LINE_SIZE? BOOST_WUP_CACHE_LINE_SIZE: std::alignment_of<T>::value )>
+{
+};
+
+// Per thread free list of blocks of one size class. Blocks freed by another
+// thread than the one that allocated them join the list of that thread.
+// The list is a plain thread_local so that it stays usable while the
+// thread_local objects of the thread are being destroyed.
+
+template<std::size_t Size>
+class wup_pool
+{
+    struct node
+    {
+        node * next;
+    };
+
+    struct list
+    {
+        node * head;
+        std::size_t count;
+        bool reaped;
+    };
+
+    struct reaper
+    {
+        ~reaper() noexcept
+        {
+            list & l = get_list();
+            l.reaped = true;
+
+            while( l.head )
+            {
+                node * n = l.head;
+                l.head = n->next;
+                ::operator delete( n );
+            }
+
+            l.count = 0;
+        }
+    };
+
+    // blocks kept per thread, the rest goes back to operator delete
+    static const std::size_t max_count = 1024;
+
+    static list & get_list() noexcept
+    {
+        static thread_local list l = { 0, 0, false };
+        return l;
+    }
+
+public:
+
+    static void * allocate()
+    {
+        list & l = get_list();
+
+        if( node * n = l.head )
+        {
+            l.head = n->next;
+            --l.count;
+            return n;
+        }
+
+        return ::operator new( Size );
+    }
+
+    static void deallocate( void * p ) noexcept
+    {
+        list & l = get_list();
+
+        if( l.reaped || l.count == max_count )
+        {
+            ::operator delete( p );
+            return;
+        }
+
+        static thread_local reaper r;
+        ( void )r;
+
+        node * n = static_cast<node*>( p );
+        n->next = l.head;
+        l.head = n;
+        ++l.count;
+    }
+};
+
+} // namespace detail
+
+// Allocator that serves single objects from a thread local free list per
+// size class, for control blocks and blocks from allocate_weakable_unique.
+template<class T>
+class weakable_pool_allocator
+{
+    // a size class for every 16 bytes
+    static const std::size_t size_class = ( sizeof( T ) + 15 ) / 16 * 16;
+
+public:
+
+    typedef T value_type;
+
+    weakable_pool_allocator() noexcept
+    {
+    }
+
+    template<class Y>
+    weakable_pool_allocator( const weakable_pool_allocator<Y>& ) noexcept
+    {
+    }
+
+    T * allocate( std::size_t n )
+    {
+        static_assert( std::alignment_of<T>::value <= std::alignment_of<std::max_align_t>::value,
+            "Over-aligned types are not supported by weakable_pool_allocator" );
+
+        if( n != 1 )
+        {
+            return std::allocator<T>().allocate( n );
+        }
+
+        return static_cast<T*>( boost::detail::wup_pool<size_class>::allocate() );
+    }
+
+    void deallocate( T * p, std::size_t n ) noexcept
+    {
+        if( n != 1 )
+        {
+            std::allocator<T>().deallocate( p, n );
+            return;
+        }
+
+        boost::detail::wup_pool<size_class>::deallocate( p );
+    }
+
+    template<class Y>
+    bool operator==( const weakable_pool_allocator<Y>& ) const noexcept
+    {
+        return true;
+    }
+
+    template<class Y>
+    bool operator!=( const weakable_pool_allocator<Y>& ) const noexcept
+    {
+        return false;
+    }
+};
+
+// Threading policies of weakable_unique_ptr and unique_weak_ptr.
+
+// The owner and all its observers are used by a single thread.
+struct weakable_single_threaded
+{
+    typedef boost::detail::wup_state_st state;
+
+    typedef std::false_type compact_layout;
+
+    // the owner destroys the object itself, see weakable_epoch
+    typedef std::false_type deferred_reclamation;
+
+    // allocates the control blocks that are not given an allocator
+    typedef std::allocator<void> allocator_type;
+};
+
+// Observers may be used by other threads than the owner. The reference
+// count and the pointer are atomic, and unique_weak_ptr::lock() pins the
+// object so that the owner waits for the reader before destroying it.
+// With BOOST_SP_DISABLE_THREADS this is weakable_single_threaded under
+// another name: the two still do not mix.
+struct weakable_multi_threaded
+{
+    typedef boost::detail::wup_state_threaded state;
+
+    typedef std::false_type compact_layout;
+
+    typedef std::false_type deferred_reclamation;
+
+    typedef std::allocator<void> allocator_type;
+};
+
+// As weakable_multi_threaded, with control blocks that start on a cache line
+// and keep the pointer away from the counts: observers copied across
+// threads do not invalidate the line that expired() and try_get() read,
+// nor the lines of blocks allocated next to theirs. A block takes two
+// lines. Blocks given an allocator must be aligned by it, as the default
+// one of this policy aligns them.
+struct weakable_cache_aligned: weakable_multi_threaded
+{
+    typedef boost::detail::wup_state_threaded_split state;
+
+    typedef boost::alignment::aligned_allocator<void, BOOST_WUP_CACHE_LINE_SIZE> allocator_type;
+};
+
+// The owner keeps only the control block, so it takes one pointer and
+// get() is one dependent load, but the block is allocated together with
+// the owner instead of on the first observation.
+template<class Base = weakable_single_threaded>
+struct weakable_compact: Base
+{
+    typedef std::true_type compact_layout;
+};
+
+// Control blocks, and the objects of make_weakable_unique with theirs, come
+// from weakable_pool_allocator instead of the heap.
+template<class Base = weakable_single_threaded>
+struct weakable_pooled: Base
+{
+    typedef weakable_pool_allocator<void> allocator_type;
+};
+
+namespace detail {
+
+template<class S, bool = S::expiry_hooks::value>
+struct wup_select_hooked
+{
+    typedef S type;
+};
+
+template<class S>
+struct wup_select_hooked<S, false>
+{
+    typedef wup_state_hooked<S> type;
+};
+}
+
+// The control blocks keep a list of weak_expiry_hook. The states of
+// weakable_multi_threaded have one anyway, the single threaded one gets it.
+template<class Base = weakable_single_threaded>
+struct weakable_hooked: Base
+{
+    typedef typename boost::detail::wup_select_hooked<typename Base::state>::type state;
+};
+
+template<class T, class Policy>
+class enable_weakable_from_this;
+
+namespace detail {
+
+// The control block does not depend on the type of the object: one block
+// type and one release path per policy. Observers keep their own pointer,
+// px here only tells whether the object is alive and, for the compact
+// layout, is the pointer of the owner.
+template<class P>
+class weakable_unique_ptr_control_block
+{
+    typename P::state st;
+
+protected:
+
+    virtual ~weakable_unique_ptr_control_block() noexcept
+    {
+    }
+
+public:
+    explicit weakable_unique_ptr_control_block( void* p ) noexcept
+        : st( p )
+    {
+    }
+
+    weakable_unique_ptr_control_block( const weakable_unique_ptr_control_block& r ) = delete;
+    weakable_unique_ptr_control_block& operator=( const weakable_unique_ptr_control_block& r ) = delete;
+
+    // a block allocated by P::allocator_type
+    static weakable_unique_ptr_control_block * create( void* p );
+
+    // expires the observers, waits for the pinned ones
+    void reset() noexcept
+    {
+        st.reset();
+    }
+
+    // expires the observers without waiting, for the policies that
+    // destroy the object once its readers are gone
+    void expire() noexcept
+    {
+        st.expire();
+    }
+
+    void * get() const noexcept
+    {
+        return st.get();
+    }
+
+    // get() for unique_weak_ptr::try_get(), which a state may count
+    void * peek() const noexcept
+    {
+        return st.peek();
+    }
+
+    // the owner and the observers
+    long use_count() const noexcept
+    {
+        return st.use_count();
+    }
+
+    // only the owner holds the block and nobody reads the object
+    bool exclusive() const noexcept
+    {
+        return st.exclusive();
+    }
+
+    // a converting move of a compact owner adjusts its pointer
+    void set( void* p ) noexcept
+    {
+        st.set( p );
+    }
+
+    void * pin() noexcept
+    {
+        return st.pin();
+    }
+
+    bool hook( wup_hook_node * n ) noexcept
+    {
+        return st.hook( n );
+    }
+
+    void unhook( wup_hook_node * n ) noexcept
+    {
+        st.unhook( n );
+    }
+
+    void unpin() noexcept
+    {
+        st.unpin();
+    }
+
+    // 0 if the object has expired or is borrowed already
+    void * borrow() noexcept
+    {
+        return st.borrow();
+    }
+
+    void unborrow() noexcept
+    {
+        st.unborrow();
+    }
+
+    // destroys the object kept in the storage of the block, if any
+    virtual void dispose() noexcept
+    {
+    }
+
+    // frees the block itself
+    virtual void destroy() noexcept = 0;
+
+    friend void intrusive_ptr_add_ref( weakable_unique_ptr_control_block *p ) {   
+        p->st.add_ref();
+    }
+
+    friend void intrusive_ptr_release( weakable_unique_ptr_control_block *p ) {
+        if ( p->st.release() ) {
+            p->destroy();
+        }
+    }
+};
+
+// Control block freed by the allocator it was allocated with.
+template<class P, class A>
+class weakable_unique_ptr_allocated_block
+    : public weakable_unique_ptr_control_block<P>
+    , boost::empty_value<typename boost::allocator_rebind<A, weakable_unique_ptr_allocated_block<P, A>>::type>
+{
+    typedef typename boost::allocator_rebind<A, weakable_unique_ptr_allocated_block>::type allocator_type;
+
+    weakable_unique_ptr_allocated_block( void* p, const allocator_type& a ) noexcept
+        : weakable_unique_ptr_control_block<P>( p )
+        , boost::empty_value<allocator_type>( boost::empty_init_t(), a )
+    {
+    }
+
+    ~weakable_unique_ptr_allocated_block() noexcept
+    {
+    }
+
+public:
+
+    static weakable_unique_ptr_allocated_block * create( void* p, const A& a )
+    {
+        allocator_type ba( a );
+        weakable_unique_ptr_allocated_block * pb = boost::to_address( boost::allocator_allocate( ba, 1 ) );
+        return ::new( static_cast<void*>( pb ) ) weakable_unique_ptr_allocated_block( p, ba );
+    }
+
+    void destroy() noexcept override
+    {
+        allocator_type ba( this->empty_value<allocator_type>::get() );
+        this->~weakable_unique_ptr_allocated_block();
+        boost::allocator_deallocate( ba, this, 1 );
+    }
+};
+
+template<class P>
+inline weakable_unique_ptr_control_block<P> * weakable_unique_ptr_control_block<P>::create( void* p )
+{
+    typedef typename P::allocator_type allocator_type;
+    return weakable_unique_ptr_allocated_block<P, allocator_type>::create( p, allocator_type() );
+}
+
+// Control block and object in one allocation, the same way as make_shared.
+// The object is destroyed by dispose() when the owner dies, the storage is
+// returned to the allocator by destroy() when the last reference goes away.
+template<class T, class A, class P>
+class weakable_unique_ptr_inplace_block
+    : public weakable_unique_ptr_control_block<P>
+    , boost::empty_value<typename boost::allocator_rebind<A, T>::type>
+{
+    typedef typename boost::allocator_rebind<A, T>::type allocator_type;
+    typedef typename boost::allocator_rebind<A, weakable_unique_ptr_inplace_block>::type block_allocator;
+
+    typename std::aligned_storage<sizeof( T ), wup_inplace_alignment<typename P::state, T>::value>::type storage;
+
+    explicit weakable_unique_ptr_inplace_block( const allocator_type& a ) noexcept
+        : weakable_unique_ptr_control_block<P>( &storage )
+        , boost::empty_value<allocator_type>( boost::empty_init_t(), a )
+    {
+    }
+
+    ~weakable_unique_ptr_inplace_block() noexcept
+    {
+    }
+
+public:
+
+    template<class... Args>
+    static weakable_unique_ptr_inplace_block * create( const A& a, Args&&... args )
+    {
+        block_allocator ba( a );
+        weakable_unique_ptr_inplace_block * pb = boost::to_address( boost::allocator_allocate( ba, 1 ) );
+        ::new( static_cast<void*>( pb ) ) weakable_unique_ptr_inplace_block( allocator_type( a ) );
+
+        try
+        {
+            boost::allocator_construct( pb->empty_value<allocator_type>::get(), pb->object(), std::forward<Args>( args )... );
+        }
+        catch( ... )
+        {
+            pb->destroy();
+            throw;
+        }
+
+        return pb;
+    }
+
+    T * object() noexcept
+    {
+        return static_cast<T*>( static_cast<void*>( &storage ) );
+    }
+
+    void dispose() noexcept override
+    {
+        boost::allocator_destroy( this->empty_value<allocator_type>::get(), object() );
+    }
+
+    void destroy() noexcept override
+    {
+        block_allocator ba( this->empty_value<allocator_type>::get() );
+        this->~weakable_unique_ptr_inplace_block();
+        boost::allocator_deallocate( ba, this, 1 );
+    }
+};
+
+// Control block that keeps the deleter of its object.
+template<class P, class Y, class D, class A>
+class weakable_unique_ptr_deleter_block
+    : public weakable_unique_ptr_control_block<P>
+    , boost::empty_value<D, 0>
+    , boost::empty_value<typename boost::allocator_rebind<A, weakable_unique_ptr_deleter_block<P, Y, D, A>>::type, 1>
+{
+    typedef typename boost::allocator_rebind<A, weakable_unique_ptr_deleter_block>::type allocator_type;
+
+    // the pointer that d takes, px of the block is the one of the owner
+    Y * py;
+
+    template<class E>
+    weakable_unique_ptr_deleter_block( Y * p, void * pt, E&& d, const allocator_type& a )
+        : weakable_unique_ptr_control_block<P>( pt )
+        , boost::empty_value<D, 0>( boost::empty_init_t(), std::forward<E>( d ) )
+        , boost::empty_value<allocator_type, 1>( boost::empty_init_t(), a )
+        , py( p )
+    {
+    }
+
+    ~weakable_unique_ptr_deleter_block() noexcept
+    {
+    }
+
+public:
+
+    // d is left as it was if this throws
+    template<class E>
+    static weakable_unique_ptr_deleter_block * create( Y * p, void * pt, E&& d, const A& a )
+    {
+        allocator_type ba( a );
+        weakable_unique_ptr_deleter_block * pb = boost::to_address( boost::allocator_allocate( ba, 1 ) );
+
+        try
+        {
+            return ::new( static_cast<void*>( pb ) ) weakable_unique_ptr_deleter_block( p, pt, std::forward<E>( d ), ba );
+        }
+        catch( ... )
+        {
+            boost::allocator_deallocate( ba, pb, 1 );
+            throw;
+        }
+    }
+
+    void dispose() noexcept override
+    {
+        this->boost::empty_value<D, 0>::get()( py );
+    }
+
+    void destroy() noexcept override
+    {
+        allocator_type ba( this->boost::empty_value<allocator_type, 1>::get() );
+        this->~weakable_unique_ptr_deleter_block();
+        boost::allocator_deallocate( ba, this, 1 );
+    }
+};
+
+// Control block followed by the elements of an array in one allocation,
+// for make_weakable_unique<T[]>( n ).
+template<class T, class A, class P>
+class weakable_unique_ptr_inplace_array_block
+    : public weakable_unique_ptr_control_block<P>
+    , boost::empty_value<typename boost::allocator_rebind<A, T>::type>
+{
+    typedef typename boost::allocator_rebind<A, T>::type allocator_type;
+
+    // the allocation is made of units aligned for both the block and T
+    typedef typename std::aligned_storage<sizeof( T ), std::alignment_of<T>::value>::type element_storage;
+    typedef typename std::conditional< ( std::alignment_of<T>::value > std::alignment_of<std::max_align_t>::value ),
+        element_storage, std::max_align_t >::type unit;
+    typedef typename boost::allocator_rebind<A, unit>::type block_allocator;
+
+    std::size_t n;
+
+    static const std::size_t alignment = wup_inplace_alignment<typename P::state, T>::value;
+
+    static std::size_t offset() noexcept
+    {
+        return ( sizeof( weakable_unique_ptr_inplace_array_block ) + alignment - 1 ) / alignment * alignment;
+    }
+
+    static std::size_t units( std::size_t n ) noexcept
+    {
+        return ( offset() + n * sizeof( T ) + sizeof( unit ) - 1 ) / sizeof( unit );
+    }
+
+    weakable_unique_ptr_inplace_array_block( const allocator_type& a, std::size_t n_ ) noexcept
+        : weakable_unique_ptr_control_block<P>( reinterpret_cast<char*>( this ) + offset() )
+        , boost::empty_value<allocator_type>( boost::empty_init_t(), a )
+        , n( n_ )
+    {
+    }
+
+    ~weakable_unique_ptr_inplace_array_block() noexcept
+    {
+    }
+
+public:
+
+    static weakable_unique_ptr_inplace_array_block * create( const A& a, std::size_t n )
+    {
+        if( n > ( std::size_t( -1 ) - offset() - sizeof( unit ) ) / sizeof( T ) )
+        {
+            throw std::bad_array_new_length();
+        }
+
+        block_allocator ba( a );
+        unit * pu = boost::to_address( boost::allocator_allocate( ba, units( n ) ) );
+        weakable_unique_ptr_inplace_array_block * pb = ::new( static_cast<void*>( pu ) ) weakable_unique_ptr_inplace_array_block( allocator_type( a ), n );
+
+        try
+        {
+            boost::alloc_construct_n( pb->empty_value<allocator_type>::get(), pb->object(), n );
+        }
+        catch( ... )
+        {
+            pb->~weakable_unique_ptr_inplace_array_block();
+            boost::allocator_deallocate( ba, pu, units( n ) );
+            throw;
+        }
+
+        return pb;
+    }
+
+    T * object() noexcept
+    {
+        return reinterpret_cast<T*>( reinterpret_cast<char*>( this ) + offset() );
+    }
+
+    void dispose() noexcept override
+    {
+        boost::alloc_destroy_n( this->empty_value<allocator_type>::get(), object(), n );
+    }
+
+    void destroy() noexcept override
+    {
+        block_allocator ba( this->empty_value<allocator_type>::get() );
+        std::size_t k = units( n );
+        this->~weakable_unique_ptr_inplace_array_block();
+        boost::allocator_deallocate( ba, reinterpret_cast<unit*>( this ), k );
+    }
+};
+
+// The deleter of weakable_unique_ptr made from the deleter of a unique_ptr;
+// boost::movelib::default_delete deletes the same way as std::default_delete.
+
+template<class E, class D>
+struct wup_convertible_deleter: std::is_convertible<E, D>
+{
+};
+
+template<class Y, class T>
+struct wup_convertible_deleter< boost::movelib::default_delete<Y>, std::default_delete<T> >: std::true_type
+{
+};
+
+template<class D, class E>
+inline typename std::enable_if<std::is_convertible<E, D>::value, D>::type wup_adopt_deleter( E&& e )
+{
+    return std::forward<E>( e );
+}
+
+template<class D, class Y>
+inline D wup_adopt_deleter( const boost::movelib::default_delete<Y>& )
+{
+    return D();
+}
+
+template<class D, class T, class C>
+inline void wup_dispose( D& d, T* p, C* ) noexcept
+{
+    d( p );
+}
+
+template<class T, class C>
+inline void wup_dispose( weakable_inplace_deleter&, T*, C* pc ) noexcept
+{
+    // an object made in place always has a block, which GCC cannot
+    // see on the paths of a moved-from owner
+    if( pc )
+    {
+        pc->dispose();
+    }
+}
+
+// Deleter of a shared_ptr made from an observed weakable_unique_ptr. It
+// keeps the control block, so that the observers see the object until the
+// last shared_ptr goes away, and expires them before deleting the object.
+template<class D, class C>
+class wup_shared_deleter
+    : boost::empty_value<D>
+{
+    intrusive_ptr<C> pc;
+
+public:
+
+    wup_shared_deleter( D&& d, C * c )
+        : boost::empty_value<D>( boost::empty_init_t(), std::move( d ) ), pc( c )
+    {
+    }
+
+    template<class T>
+    void operator()( T* p ) noexcept
+    {
+        pc->reset();
+        boost::detail::wup_dispose( this->boost::empty_value<D>::get(), p, pc.get() );
+
+        // the storage of an object created in place goes away now rather
+        // than with the last weak_ptr, which keeps the deleter alive
+        pc.reset();
+    }
+};
+
+// Layouts of weakable_unique_ptr, selected by Policy::compact_layout.
+
+template<class T, class C, bool Compact>
+class wup_layout;
+
+template<class T, class C>
+class wup_layout<T, C, false>
+{
+    template<class Y, class CY, bool B> friend class wup_layout;
+
+    T * px;
+
+    // The control block is created by the first unique_weak_ptr taken from
+    // the owner, so an owner that is never observed costs no allocation.
+    // Taking a unique_weak_ptr may therefore modify the owner: it must not
+    // race with another thread taking one from the same owner, or with any
+    // other access that is not a read of px. Once the block exists taking a
+    // unique_weak_ptr no longer touches the owner.
+    //
+    // pc holds one reference, counted by hand: a move is two loads and
+    // two stores, with no count and no temporary to destroy.
+    mutable C * pc;
+
+public:
+
+    static const bool eager = false;
+
+    constexpr wup_layout() noexcept : px( 0 ), pc( 0 )
+    {
+    }
+
+    wup_layout( T * p, C * c ) noexcept : px( p ), pc( c )
+    {
+        if( c )
+        {
+            intrusive_ptr_add_ref( c );
+        }
+    }
+
+    BOOST_CXX14_CONSTEXPR wup_layout( wup_layout&& r ) noexcept : px( r.px ), pc( r.pc )
+    {
+        r.px = 0;
+        r.pc = 0;
+    }
+
+    template<class Y>
+    BOOST_CXX14_CONSTEXPR wup_layout( wup_layout<Y, C, false>&& r ) noexcept
+        : px( r.px ), pc( r.pc )
+    {
+        r.px = 0;
+        r.pc = 0;
+    }
+
+    BOOST_WUP_CXX20_CONSTEXPR ~wup_layout() noexcept
+    {
+        if( pc )
+        {
+            intrusive_ptr_release( pc );
+        }
+    }
+
+    constexpr T * get() const noexcept
+    {
+        return px;
+    }
+
+    constexpr C * get_block() const noexcept
+    {
+        return pc;
+    }
+
+    C * acquire_block() const
+    {
+        if( !pc && px )
+        {
+            C * c = C::create( px );
+            intrusive_ptr_add_ref( c );
+            pc = c;
+        }
+        return pc;
+    }
+
+    void clear() noexcept
+    {
+        px = 0;
+
+        if( pc )
+        {
+            intrusive_ptr_release( boost::exchange( pc, nullptr ) );
+        }
+    }
+
+    // frees the block without counting down, when only the owner holds it
+    void free_block() noexcept
+    {
+        boost::exchange( pc, nullptr )->destroy();
+    }
+
+    // takes p in place of the pointer when no observer holds the block
+    bool reuse_block( T * p ) noexcept
+    {
+        if( pc && !pc->exclusive() )
+        {
+            return false;
+        }
+
+        px = p;
+
+        if( pc )
+        {
+            pc->set( p );
+        }
+        return true;
+    }
+
+    // gives up the pointer, the observers expire
+    T * release() noexcept
+    {
+        T * p = px;
+
+        if( pc )
+        {
+            pc->reset();
+        }
+
+        clear();
+        return p;
+    }
+
+    template<class D>
+    static void dispose( D& d, T* p, C* c ) noexcept
+    {
+        boost::detail::wup_dispose( d, p, c );
+    }
+
+    // what the destruction reads: the object and the block
+    void prefetch() const noexcept
+    {
+        boost::detail::wup_prefetch( px );
+        boost::detail::wup_prefetch( pc );
+    }
+
+    BOOST_CXX14_CONSTEXPR void swap( wup_layout& r ) noexcept
+    {
+        boost::detail::wup_swap( px, r.px );
+        boost::detail::wup_swap( pc, r.pc );
+    }
+};
+
+template<class T, class C>
+class wup_layout<T, C, true>
+{
+    template<class Y, class CY, bool B> friend class wup_layout;
+
+    C * pc; // the pointer lives in the block, one reference
+
+public:
+
+    static const bool eager = true;
+
+    constexpr wup_layout() noexcept : pc( 0 )
+    {
+    }
+
+    wup_layout( T *, C * c ) noexcept : pc( c )
+    {
+        if( c )
+        {
+            intrusive_ptr_add_ref( c );
+        }
+    }
+
+    BOOST_CXX14_CONSTEXPR wup_layout( wup_layout&& r ) noexcept : pc( r.pc )
+    {
+        r.pc = 0;
+    }
+
+    template<class Y>
+    wup_layout( wup_layout<Y, C, true>&& r ) noexcept
+        : pc( r.pc )
+    {
+        r.pc = 0;
+
+        if( pc )
+        {
+            pc->set( static_cast<T*>( static_cast<Y*>( pc->get() ) ) );
+        }
+    }
+
+    BOOST_WUP_CXX20_CONSTEXPR ~wup_layout() noexcept
+    {
+        if( pc )
+        {
+            intrusive_ptr_release( pc );
+        }
+    }
+
+    constexpr T * get() const noexcept
+    {
+        return pc ? static_cast<T*>( pc->get() ) : 0;
+    }
+
+    constexpr C * get_block() const noexcept
+    {
+        return pc;
+    }
+
+    C * acquire_block() const noexcept
+    {
+        return pc;
+    }
+
+    void clear() noexcept
+    {
+        if( pc )
+        {
+            intrusive_ptr_release( boost::exchange( pc, nullptr ) );
+        }
+    }
+
+    void free_block() noexcept
+    {
+        boost::exchange( pc, nullptr )->destroy();
+    }
+
+    bool reuse_block( T * p ) noexcept
+    {
+        if( !pc || !pc->exclusive() )
+        {
+            return false;
+        }
+
+        pc->set( p );
+        return true;
+    }
+
+    T * release() noexcept
+    {
+        T * p = get();
+
+        if( pc )
+        {
+            pc->reset();
+        }
+
+        clear();
+        return p;
+    }
+
+    template<class D>
+    static void dispose( D& d, T* p, C* c ) noexcept
+    {
+        boost::detail::wup_dispose( d, p, c );
+    }
+
+    // the block, which holds the pointer of the object
+    void prefetch() const noexcept
+    {
+        boost::detail::wup_prefetch( pc );
+    }
+
+    BOOST_CXX14_CONSTEXPR void swap( wup_layout& r ) noexcept
+    {
+        boost::detail::wup_swap( pc, r.pc );
+    }
+};
+
+// The control block belongs to the object, see enable_weakable_from_this.
+template<class T, class C>
+class wup_intrusive_layout
+{
+    template<class Y, class CY> friend class wup_intrusive_layout;
+
+    T * px;
+
+public:
+
+    static const bool eager = false;
+
+    constexpr wup_intrusive_layout() noexcept : px( 0 )
+    {
+    }
+
+    wup_intrusive_layout( T * p, C * c ) noexcept : px( p )
+    {
+        if( c )
+        {
+            p->adopt_weakable_block( c );
+        }
+    }
+
+    BOOST_CXX14_CONSTEXPR wup_intrusive_layout( wup_intrusive_layout&& r ) noexcept : px( r.px )
+    {
+        r.px = 0;
+    }
+
+    template<class Y>
+    BOOST_CXX14_CONSTEXPR wup_intrusive_layout( wup_intrusive_layout<Y, C>&& r ) noexcept : px( r.px )
+    {
+        r.px = 0;
+    }
+
+    constexpr T * get() const noexcept
+    {
+        return px;
+    }
+
+    constexpr C * get_block() const noexcept
+    {
+        return px ? px->get_weakable_block() : 0;
+    }
+
+    C * acquire_block() const
+    {
+        return px ? px->acquire_weakable_block( px ) : 0;
+    }
+
+    void clear() noexcept
+    {
+        px = 0;
+    }
+
+    // the object has dropped its reference to the block
+    void free_block() noexcept
+    {
+    }
+
+    // the block belongs to the old object
+    bool reuse_block( T * ) noexcept
+    {
+        return false;
+    }
+
+    // the observers follow the object to its next owner
+    T * release() noexcept
+    {
+        return boost::exchange( px, nullptr );
+    }
+
+    template<class D>
+    static void dispose( D& d, T* p, C* c ) noexcept
+    {
+        boost::detail::wup_dispose( d, p, c );
+    }
+
+    // the object drops its reference to the block that it lives in
+    // while the block destroys it
+    static void dispose( weakable_inplace_deleter& d, T* p, C* c ) noexcept
+    {
+        intrusive_ptr<C> keep( c );
+        boost::detail::wup_dispose( d, p, c );
+    }
+
+    // the object, which holds the block
+    void prefetch() const noexcept
+    {
+        boost::detail::wup_prefetch( px );
+    }
+
+    BOOST_CXX14_CONSTEXPR void swap( wup_intrusive_layout& r ) noexcept
+    {
+        boost::detail::wup_swap( px, r.px );
+    }
+};
+
+// The part of enable_weakable_from_this that does not depend on T.
+template<class P>
+class wup_from_this_base
+{
+    typedef weakable_unique_ptr_control_block<P> control_block;
+
+    mutable intrusive_ptr<control_block> pc;
+
+    template<class Y, class C> friend class wup_intrusive_layout;
+    template<class Y, class PY> friend class boost::enable_weakable_from_this;
+
+    control_block * get_weakable_block() const noexcept
+    {
+        return pc.get();
+    }
+
+    control_block * acquire_weakable_block( void* p ) const
+    {
+        if( !pc )
+        {
+            pc.reset( control_block::create( p ) );
+        }
+        return pc.get();
+    }
+
+    // a block created by make_weakable_unique replaces one
+    // created while the object was being constructed
+    void adopt_weakable_block( control_block * c ) noexcept
+    {
+        if( pc )
+        {
+            pc->reset();
+        }
+        pc.reset( c );
+    }
+
+protected:
+
+    constexpr wup_from_this_base() noexcept : pc( )
+    {
+    }
+
+    wup_from_this_base( const wup_from_this_base& ) noexcept : pc( )
+    {
+    }
+
+    wup_from_this_base& operator=( const wup_from_this_base& ) noexcept
+    {
+        return *this;
+    }
+
+    ~wup_from_this_base() noexcept
+    {
+        if( pc )
+        {
+            pc->reset();
+        }
+    }
+};
+}
+
+template<class T, class Policy = weakable_single_threaded>
+class unique_weak_ptr;
+
+template<class T, class Policy>
+class weak_observer_list;
+
+template<class Policy>
+class weak_expiry_hook;
+
+template<class K, class V, class Policy>
+class weak_key_map;
+
+// Base class of the objects that keep their own control block. The owner
+// of such an object stores only the pointer, and the object can hand out
+// unique_weak_ptrs to itself with weak_from_this() wherever it lives.
+//
+// The block is created by the first observation, with the same thread
+// safety rules as the control block of weakable_unique_ptr. The observers
+// expire when the owner dies or, for an object without a
+// weakable_unique_ptr owner, when this base is destroyed, that is after
+// the destructor of T has run.
+template<class T, class Policy = weakable_single_threaded>
+class enable_weakable_from_this: public boost::detail::wup_from_this_base<Policy>
+{
+    typedef boost::detail::wup_from_this_base<Policy> base_type;
+
+protected:
+
+    constexpr enable_weakable_from_this() noexcept
+    {
+    }
+
+    enable_weakable_from_this( const enable_weakable_from_this& r ) noexcept : base_type( r )
+    {
+    }
+
+    enable_weakable_from_this& operator=( const enable_weakable_from_this& ) noexcept
+    {
+        return *this;
+    }
+
+    ~enable_weakable_from_this() noexcept
+    {
+    }
+
+public:
+
+    unique_weak_ptr<T, Policy> weak_from_this()
+    {
+        T * p = static_cast<T*>( this );
+        return unique_weak_ptr<T, Policy>( boost::detail::wup_internal_constructor_tag(), p, this->acquire_weakable_block( p ) );
+    }
+
+    unique_weak_ptr<T const, Policy> weak_from_this() const
+    {
+        T const * p = static_cast<T const*>( this );
+        return unique_weak_ptr<T const, Policy>( boost::detail::wup_internal_constructor_tag(), p,
+            this->acquire_weakable_block( const_cast<T*>( p ) ) );
+    }
+};
+
+namespace detail {
+
+template<class T, class P>
+struct wup_is_intrusive: std::is_base_of<wup_from_this_base<P>, T>
+{
+};
+
+template<class It> void wup_destroy_all( It first, It last, std::true_type ) noexcept;
+
+// for enable_weakable_from_this<T> the block is stored in the object
+template<class T, class C, class P>
+struct wup_select_layout
+{
+    typedef typename sp_element<T>::type E;
+
+    typedef typename std::conditional< wup_is_intrusive<T, P>::value,
+        wup_intrusive_layout<E, C>,
+        wup_layout<E, C, P::compact_layout::value> >::type type;
+};
+}
+
+template<class T, class Deleter = std::default_delete<T>, class Policy = weakable_single_threaded>
+class BOOST_WUP_RELOCATABLE_IF( std::is_trivially_copyable<Deleter>::value ) weakable_unique_ptr BOOST_WUP_RELOCATABLE_IF_ELIGIBLE
+    : boost::empty_value<Deleter> // a stateless deleter takes no space
+    , boost::detail::wup_extent<T>
+{
+public:
+
+    static_assert( std::extent<T>::value == 0, "Arrays of known bound are not supported, use T[]" );
+
+    // TODO: implement support for reference deleter
+    static_assert( !std::is_reference<T>::value, "Reference as deleter is not supported" );
+
+    typedef Deleter deleter_type;
+    typedef Policy policy_type;
+    typedef typename boost::detail::sp_element<T>::type element_type;
+    typedef element_type* pointer;
+
+private:
+
+    typedef boost::detail::weakable_unique_ptr_control_block<Policy> control_block;
+    typedef typename boost::detail::wup_select_layout<T, control_block, Policy>::type layout_type;
+    typedef boost::detail::wup_extent<T> extent_type;
+
+    static const bool nothrow_construct = !layout_type::eager;
+
+    layout_type pb; // the pointer and the control block
+
+    template<class Y, class E, class P> friend class weakable_unique_ptr;
+    template<class Y, class P> friend class unique_weak_ptr;
+
+    Deleter& deleter() noexcept
+    {
+        return boost::empty_value<Deleter>::get();
+    }
+
+    constexpr const extent_type& extent() const noexcept
+    {
+        return *this;
+    }
+
+    control_block * get_control_block() const
+    {
+        return pb.acquire_block();
+    }
+
+    control_block * create_control_block( pointer, std::false_type ) noexcept
+    {
+        return 0;
+    }
+
+    // the block of an eager layout
+    control_block * create_control_block( pointer p, std::true_type )
+    {
+        return create_control_block( p, typename Policy::allocator_type() );
+    }
+
+    // p is destroyed if its block can not be allocated
+    template<class A>
+    control_block * create_control_block( pointer p, const A& a )
+    {
+        if( !p )
+        {
+            return 0;
+        }
+
+        try
+        {
+            return boost::detail::weakable_unique_ptr_allocated_block<Policy, A>::create( p, a );
+        }
+        catch( ... )
+        {
+            boost::detail::wup_dispose( deleter(), p, static_cast<control_block*>( 0 ) );
+            throw;
+        }
+    }
+
+    control_block * create_control_block( pointer p ) noexcept( nothrow_construct )
+    {
+        return create_control_block( p, std::integral_constant<bool, layout_type::eager>() );
+    }
+
+    // the block that keeps d, for weakable_inplace_deleter
+
+    template<class Y, class E>
+    static control_block * adopt_deleter_block( Y * p, E&& d )
+    {
+        static_assert( !std::is_array<T>::value, "Use make_weakable_unique to create an array with an erased deleter" );
+
+        typedef typename std::decay<E>::type D;
+        typedef typename Policy::allocator_type A;
+
+        if( !p )
+        {
+            return 0;
+        }
+
+        element_type * pt = p;
+        return boost::detail::weakable_unique_ptr_deleter_block<Policy, Y, D, A>::create( p, pt, std::forward<E>( d ), A() );
+    }
+
+    // p is deleted with d if its block can not be allocated
+    template<class Y, class D>
+    static control_block * create_deleter_block( Y * p, D& d )
+    {
+        try
+        {
+            return adopt_deleter_block( p, std::move( d ) );
+        }
+        catch( ... )
+        {
+            d( p );
+            throw;
+        }
+    }
+
+    // an object that nobody observes goes to the shared_ptr with its deleter
+    template<class S>
+    S to_shared( std::false_type )
+    {
+        control_block * pc = pb.get_block();
+
+        if( pc && pc->use_count() != 1 )
+        {
+            return to_shared<S>( std::true_type() );
+        }
+
+        pointer p = pb.release();
+        return S( p, std::move( deleter() ) );
+    }
+
+    template<class S>
+    S to_shared( std::true_type )
+    {
+        pointer p = pb.get();
+
+        if( !p )
+        {
+            return S();
+        }
+
+        boost::detail::wup_shared_deleter<Deleter, control_block> d( std::move( deleter() ), pb.get_block() );
+        pb.clear();
+        return S( p, std::move( d ) );
+    }
+
+    template<class S>
+    S to_shared()
+    {
+        return to_shared<S>( std::integral_constant<bool, std::is_same<Deleter, weakable_inplace_deleter>::value>() );
+    }
+
+    // a unique_ptr keeps its pointer if the block can not be allocated
+
+    static control_block * adopt_control_block( pointer, std::false_type ) noexcept
+    {
+        return 0;
+    }
+
+    static control_block * adopt_control_block( pointer p, std::true_type )
+    {
+        return p ? control_block::create( p ) : 0;
+    }
+
+    static control_block * adopt_control_block( pointer p ) noexcept( nothrow_construct )
+    {
+        return adopt_control_block( p, std::integral_constant<bool, layout_type::eager>() );
+    }
+
+    // the observers expire before the object is destroyed,
+    // so that no pinned reader can see it half destroyed
+
+    static void expire_observers( control_block * pc, std::false_type ) noexcept
+    {
+        pc->reset();
+    }
+
+    static void expire_observers( control_block * pc, std::true_type ) noexcept
+    {
+        pc->expire();
+    }
+
+    void dispose_expired( pointer p, control_block * pc, std::false_type ) noexcept
+    {
+        layout_type::dispose( deleter(), p, pc );
+    }
+
+    // readers may still be in the object, the policy destroys it later
+    void dispose_expired( pointer p, control_block * pc, std::true_type ) noexcept
+    {
+        Policy::state::template retire<layout_type>( std::move( deleter() ), p, pc );
+    }
+
+    void dispose_observed( pointer p, control_block * pc ) noexcept
+    {
+        typename Policy::deferred_reclamation d;
+
+        expire_observers( pc, d );
+
+        if( p )
+        {
+            dispose_expired( p, pc, d );
+        }
+    }
+
+    // weakable_destroy_all, which resets each owner with the memory of the
+    // owners a few places ahead already on its way
+    template<class It> friend void boost::detail::wup_destroy_all( It first, It last, std::true_type ) noexcept;
+
+    static const std::size_t destroy_distance = 8;
+
+    void prefetch() const noexcept
+    {
+        pb.prefetch();
+    }
+
+    // destroys the object of l with the deleter of this, and lets go of
+    // the block; the destructor, and reset() on the layout it took out
+    BOOST_WUP_CXX20_CONSTEXPR void dispose_layout( layout_type & l ) noexcept
+    {
+        pointer p = l.get();
+        control_block * pc = l.get_block();
+
+        // nobody to expire: the block goes away with the object,
+        // without its pointer being cleared first
+        if( pc && pc->exclusive() )
+        {
+            if( p )
+            {
+                layout_type::dispose( deleter(), p, pc );
+            }
+
+            l.free_block();
+            return;
+        }
+
+        if( pc )
+        {
+            dispose_observed( p, pc );
+        }
+        else if( p )
+        {
+            layout_type::dispose( deleter(), p, pc );
+        }
+    }
+
+    // takes the object of l, then destroys the old object with the old
+    // deleter before d replaces it, as the assignment of unique_ptr does
+    template<class D>
+    BOOST_WUP_CXX20_CONSTEXPR void assign_layout( layout_type & l, const extent_type& e, D&& d ) noexcept
+    {
+        layout_type old( std::move( pb ) );
+
+        pb.swap( l );
+        static_cast<extent_type&>( *this ) = e;
+
+        dispose_layout( old );
+
+        deleter() = std::forward<D>( d );
+    }
+
+    // operator=( unique_ptr&& ); r keeps its object if the block can not
+    // be allocated
+
+    template<class U>
+    void assign_unique( U& r, std::false_type ) noexcept( nothrow_construct )
+    {
+        static_assert( !std::is_array<T>::value,
+            "Give the length of the array that its observers see" );
+
+        layout_type l( r.get(), adopt_control_block( r.get() ) );
+        assign_layout( l, extent_type(), boost::detail::wup_adopt_deleter<Deleter>( std::forward<typename U::deleter_type>( r.get_deleter() ) ) );
+        r.release();
+    }
+
+    // the deleter of r goes to a block, for weakable_inplace_deleter
+    template<class U>
+    void assign_unique( U& r, std::true_type )
+    {
+        layout_type l( r.get(), adopt_deleter_block( r.get(), std::forward<typename U::deleter_type>( r.get_deleter() ) ) );
+        r.release();
+        assign_layout( l, extent_type(), Deleter() );
+    }
+
+    // reset( p ) and reset( p, n )
+    void reset_pointer( pointer p, std::size_t n ) noexcept( nothrow_construct )
+    {
+        static_assert( !std::is_same<Deleter, weakable_inplace_deleter>::value,
+            "Use make_weakable_unique or allocate_weakable_unique to create an object in place" );
+
+        pointer old = pb.get();
+
+        if( p && pb.reuse_block( p ) )
+        {
+            static_cast<extent_type&>( *this ) = extent_type( n );
+
+            if( old )
+            {
+                layout_type::dispose( deleter(), old, static_cast<control_block*>( 0 ) );
+            }
+        }
+        else
+        {
+            // this holds p before the old object is destroyed
+            layout_type old( p, create_control_block( p ) );
+
+            pb.swap( old );
+            static_cast<extent_type&>( *this ) = extent_type( n );
+
+            dispose_layout( old );
+        }
+    }
+
+public:
+
+    // destructor
+
+    BOOST_WUP_CXX20_CONSTEXPR ~weakable_unique_ptr() noexcept
+    {
+        dispose_layout( pb );
+    }
+
+    // constructors
+
+    constexpr weakable_unique_ptr() noexcept
+        : boost::empty_value<Deleter>( ), pb( )
+    {
+    }
+
+    constexpr weakable_unique_ptr( std::nullptr_t ) noexcept
+        : boost::empty_value<Deleter>( ), pb( )
+    {
+    }
+
+    explicit weakable_unique_ptr( pointer p ) noexcept( nothrow_construct )
+        : boost::empty_value<Deleter>( ), pb( p, create_control_block( p ) )
+    {
+        static_assert( !std::is_array<T>::value,
+            "Give the length of the array that its observers see" );
+        static_assert( !std::is_same<Deleter, weakable_inplace_deleter>::value,
+            "Give the deleter of p, or use make_weakable_unique or allocate_weakable_unique to create an object in place" );
+    }
+
+    // The control block keeps d and destroys p with it. The block is
+    // allocated right away, p is deleted with d if that throws.
+    template<class Y, class D>
+    weakable_unique_ptr( Y * p, D d,
+        typename std::enable_if<std::is_same<Deleter, weakable_inplace_deleter>::value && !std::is_same<D, weakable_inplace_deleter>::value
+            && std::is_convertible<Y*, T*>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() )
+        : boost::empty_value<Deleter>( ), pb( p, create_deleter_block( p, d ) )
+    {
+    }
+
+    // internal constructor, used by make_weakable_unique and allocate_weakable_unique
+
+    weakable_unique_ptr( boost::detail::wup_internal_constructor_tag, pointer p,
+        boost::detail::weakable_unique_ptr_control_block<Policy> * pc_, std::size_t n = 1 ) noexcept
+        : boost::empty_value<Deleter>( ), extent_type( n ), pb( p, pc_ )
+    {
+    }
+
+    // an array of n elements, the length that its observers see
+    template<class Y = T>
+    weakable_unique_ptr( pointer p, std::size_t n,
+        typename std::enable_if<std::is_array<Y>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() ) noexcept( nothrow_construct )
+        : boost::empty_value<Deleter>( ), extent_type( n ), pb( p, create_control_block( p ) )
+    {
+        static_assert( !std::is_same<Deleter, weakable_inplace_deleter>::value,
+            "Use make_weakable_unique or allocate_weakable_unique to create an object in place" );
+    }
+
+    template<class D = deleter_type, class Y = T>
+    weakable_unique_ptr( pointer p, std::size_t n, const D& d,
+        typename boost::detail::sp_enable_if_convertible<D, Deleter>::type = boost::detail::sp_empty(),
+        typename std::enable_if<std::is_array<Y>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() ) noexcept( nothrow_construct )
+        : boost::empty_value<Deleter>( boost::empty_init_t(), d ), extent_type( n ), pb( p, create_control_block( p ) )
+    {
+        boost::detail::sp_assert_convertible< D, Deleter >();
+    }
+
+    template<class D = deleter_type>
+    weakable_unique_ptr( pointer p, const D& d,
+        typename boost::detail::sp_enable_if_convertible<D, Deleter>::type = boost::detail::sp_empty() ) noexcept( nothrow_construct )
+        : boost::empty_value<Deleter>( boost::empty_init_t(), d ), pb( p, create_control_block( p ) )
+    {
+        boost::detail::sp_assert_convertible< D, Deleter >();
+        static_assert( !std::is_array<T>::value,
+            "Give the length of the array that its observers see" );
+    }
+
+    template<class Y, class D = deleter_type>
+    weakable_unique_ptr( pointer p, D&& d,
+        typename boost::detail::sp_enable_if_convertible<D, Deleter>::type = boost::detail::sp_empty() ) noexcept( nothrow_construct )
+        : boost::empty_value<Deleter>( boost::empty_init_t(), std::forward<D>(d) ), pb( p, create_control_block( p ) )
+    {
+        boost::detail::sp_assert_convertible< D, Deleter >();
+    }
+
+    // The control block is allocated with a right away, for example from
+    // a std::pmr::polymorphic_allocator over a per-request arena. The memory
+    // of a must outlive the owner and all its observers.
+    template<class D, class A>
+    weakable_unique_ptr( pointer p, const D& d, const A& a,
+        typename boost::detail::sp_enable_if_convertible<D, Deleter>::type = boost::detail::sp_empty() )
+        : boost::empty_value<Deleter>( boost::empty_init_t(), d ), pb( p, create_control_block( p, a ) )
+    {
+        boost::detail::sp_assert_convertible< D, Deleter >();
+        static_assert( !std::is_array<T>::value,
+            "Give the length of the array that its observers see" );
+        static_assert( !std::is_same<Deleter, weakable_inplace_deleter>::value,
+            "Use allocate_weakable_unique to create an object in place" );
+    }
+
+    // move constructor
+
+    BOOST_WUP_CXX20_CONSTEXPR weakable_unique_ptr( weakable_unique_ptr && r ) noexcept
+        : boost::empty_value<Deleter>( static_cast<boost::empty_value<Deleter>&&>( r ) ), extent_type( r.extent() ), pb( std::move( r.pb ) )
+    {
+    }
+
+    // converting move constructor; the block of an object with
+    // enable_weakable_from_this stays with the object, so its owner
+    // converts only to an owner of a T that derives from it as well
+
+    template<class Y, class E> weakable_unique_ptr( weakable_unique_ptr<Y, E, Policy> && r,
+        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty(),
+        typename std::enable_if<std::is_convertible<E, Deleter>::value
+            && boost::detail::wup_is_intrusive<Y, Policy>::value == boost::detail::wup_is_intrusive<T, Policy>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() ) noexcept
+        : boost::empty_value<Deleter>( boost::empty_init_t(), std::move( r.deleter() ) ), extent_type( r.extent().size() ), pb( std::move( r.pb ) )
+    {
+        boost::detail::sp_assert_convertible< Y, T >();
+    }
+
+    // copy constructor
+
+    weakable_unique_ptr( weakable_unique_ptr const & r ) = delete;
+
+    // construction from unique_ptr, allocates nothing until the first
+    // observer unless the layout is compact
+
+    template<class Y, class E>
+    weakable_unique_ptr( std::unique_ptr<Y, E> && r,
+        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty(),
+        typename std::enable_if<boost::detail::wup_convertible_deleter<E, Deleter>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() ) noexcept( nothrow_construct )
+        : boost::empty_value<Deleter>( boost::empty_init_t(), boost::detail::wup_adopt_deleter<Deleter>( std::forward<E>( r.get_deleter() ) ) ),
+          pb( r.get(), adopt_control_block( r.get() ) )
+    {
+        boost::detail::sp_assert_convertible< Y, T >();
+        static_assert( !std::is_array<T>::value,
+            "Give the length of the array that its observers see" );
+        r.release();
+    }
+
+    // an array of n elements, unique_ptr does not know the length
+    template<class Y, class E>
+    weakable_unique_ptr( std::unique_ptr<Y, E> && r, std::size_t n,
+        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty(),
+        typename std::enable_if<std::is_array<Y>::value && boost::detail::wup_convertible_deleter<E, Deleter>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() ) noexcept( nothrow_construct )
+        : boost::empty_value<Deleter>( boost::empty_init_t(), boost::detail::wup_adopt_deleter<Deleter>( std::forward<E>( r.get_deleter() ) ) ),
+          extent_type( n ), pb( r.get(), adopt_control_block( r.get() ) )
+    {
+        r.release();
+    }
+
+    // the control block takes the deleter of r, r is left as it was if
+    // the block can not be allocated
+    template<class Y, class E>
+    weakable_unique_ptr( std::unique_ptr<Y, E> && r,
+        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty(),
+        typename std::enable_if<std::is_same<Deleter, weakable_inplace_deleter>::value && !std::is_same<E, weakable_inplace_deleter>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() )
+        : boost::empty_value<Deleter>( ), pb( r.get(), adopt_deleter_block( r.get(), std::forward<E>( r.get_deleter() ) ) )
+    {
+        boost::detail::sp_assert_convertible< Y, T >();
+        static_assert( !std::is_array<T>::value,
+            "Give the length of the array that its observers see" );
+        r.release();
+    }
+
+    template<class Y, class E>
+    weakable_unique_ptr( boost::movelib::unique_ptr<Y, E> && r,
+        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty(),
+        typename std::enable_if<boost::detail::wup_convertible_deleter<E, Deleter>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() ) noexcept( nothrow_construct )
+        : boost::empty_value<Deleter>( boost::empty_init_t(), boost::detail::wup_adopt_deleter<Deleter>( std::forward<E>( r.get_deleter() ) ) ),
+          pb( r.get(), adopt_control_block( r.get() ) )
+    {
+        boost::detail::sp_assert_convertible< Y, T >();
+        static_assert( !std::is_array<T>::value,
+            "Give the length of the array that its observers see" );
+        r.release();
+    }
+
+    template<class Y, class E>
+    weakable_unique_ptr( boost::movelib::unique_ptr<Y, E> && r, std::size_t n,
+        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty(),
+        typename std::enable_if<std::is_array<Y>::value && boost::detail::wup_convertible_deleter<E, Deleter>::value, boost::detail::sp_empty>::type = boost::detail::sp_empty() ) noexcept( nothrow_construct )
+        : boost::empty_value<Deleter>( boost::empty_init_t(), boost::detail::wup_adopt_deleter<Deleter>( std::forward<E>( r.get_deleter() ) ) ),
+          extent_type( n ), pb( r.get(), adopt_control_block( r.get() ) )
+    {
+        r.release();
+    }
+
+    // assignment
+
+    // no temporary owner: the old object is destroyed with the old
+    // deleter once this holds the object of r, as with unique_ptr
+    BOOST_WUP_CXX20_CONSTEXPR weakable_unique_ptr & operator=( weakable_unique_ptr && r ) noexcept
+    {
+        if( &r == this )
+        {
+            return *this;
+        }
+
+        layout_type old( std::move( pb ) );
+
+        pb.swap( r.pb );
+        static_cast<extent_type&>( *this ) = r.extent();
+
+        dispose_layout( old );
+
+        static_cast<boost::empty_value<Deleter>&>( *this ) = static_cast<boost::empty_value<Deleter>&&>( r );
+        return *this;
+    }
+
+    template<class Y, class E>
+    typename std::enable_if<std::is_convertible<weakable_unique_ptr<Y, E, Policy>&&, weakable_unique_ptr>::value, weakable_unique_ptr&>::type
+        operator=( weakable_unique_ptr<Y, E, Policy> && r ) noexcept
+    {
+        layout_type l( std::move( r.pb ) );
+        assign_layout( l, extent_type( r.extent().size() ), std::move( r.deleter() ) );
+        return *this;
+    }
+
+    BOOST_WUP_CXX20_CONSTEXPR weakable_unique_ptr & operator=( std::nullptr_t ) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    weakable_unique_ptr & operator=( weakable_unique_ptr const & r ) = delete;
+
+    // an erased deleter is kept in a block allocated now
+    template<class Y, class E>
+    weakable_unique_ptr & operator=( std::unique_ptr<Y, E> && r )
+        noexcept( std::is_nothrow_constructible<weakable_unique_ptr, std::unique_ptr<Y, E>&&>::value )
+    {
+        assign_unique( r, std::integral_constant<bool, std::is_same<Deleter, weakable_inplace_deleter>::value && !std::is_same<E, weakable_inplace_deleter>::value>() );
+        return *this;
+    }
+
+    template<class Y, class E>
+    weakable_unique_ptr & operator=( boost::movelib::unique_ptr<Y, E> && r )
+        noexcept( std::is_nothrow_constructible<weakable_unique_ptr, boost::movelib::unique_ptr<Y, E>&&>::value )
+    {
+        assign_unique( r, std::integral_constant<bool, std::is_same<Deleter, weakable_inplace_deleter>::value && !std::is_same<E, weakable_inplace_deleter>::value>() );
+        return *this;
+    }
+
+    // release
+    pointer release() noexcept
+    {
+        static_assert( !std::is_same<Deleter, weakable_inplace_deleter>::value,
+            "An object destroyed by its control block can not be released from it" );
+
+        return pb.release();
+    }
+
+    // gives the object and the deleter back to a unique_ptr,
+    // the observers expire as with release()
+    std::unique_ptr<T, Deleter> release_to_unique() noexcept
+    {
+        static_assert( !std::is_same<Deleter, weakable_inplace_deleter>::value,
+            "An object destroyed by its control block can not be released from it" );
+
+        pointer p = pb.release();
+        return std::unique_ptr<T, Deleter>( p, std::move( deleter() ) );
+    }
+
+    // reset
+
+    // this is empty before the object is destroyed, the deleter is kept
+    BOOST_WUP_CXX20_CONSTEXPR void reset() noexcept
+    {
+        layout_type old( std::move( pb ) );
+        static_cast<extent_type&>( *this ) = extent_type();
+
+        dispose_layout( old );
+    }
+
+    // keeps the control block for p when nobody observes the old object,
+    // so that a compact owner can be reset without an allocation
+    void reset( pointer p ) noexcept( nothrow_construct )
+    {
+        static_assert( !std::is_array<T>::value,
+            "Give the length of the array that its observers see" );
+
+        reset_pointer( p, 1 );
+    }
+
+    // an array of n elements, the length that its observers see
+    template<class Y = T>
+    typename std::enable_if<std::is_array<Y>::value>::type reset( pointer p, std::size_t n ) noexcept( nothrow_construct )
+    {
+        reset_pointer( p, n );
+    }
+
+    // accessors
+
+    constexpr typename boost::detail::sp_dereference< T >::type operator* () const noexcept
+    {
+        return *pb.get();
+    }
+
+    constexpr typename boost::detail::sp_member_access< T >::type operator-> () const noexcept
+    {
+        return pb.get();
+    }
+
+    constexpr typename boost::detail::sp_array_access< T >::type operator[] ( std::ptrdiff_t i ) const noexcept
+    {
+        return pb.get()[ i ];
+    }
+
+    constexpr element_type * get() const noexcept
+    {
+        return pb.get();
+    }
+
+    // the unique_weak_ptrs, lists, maps and hooks that hold the control
+    // block; with weakable_multi_threaded observers of other threads may
+    // come and go as soon as it is read
+    BOOST_CXX14_CONSTEXPR long weak_count() const noexcept
+    {
+        control_block * pc = pb.get_block();
+        return pc ? pc->use_count() - 1 : 0;
+    }
+
+    BOOST_CXX14_CONSTEXPR bool is_observed() const noexcept
+    {
+        return weak_count() != 0;
+    }
+
+    Deleter& get_deleter() noexcept
+    {
+        return boost::empty_value<Deleter>::get();
+    }
+
+    const Deleter& get_deleter() const noexcept
+    {
+        return boost::empty_value<Deleter>::get();
+    }
+
+    explicit constexpr operator bool () const noexcept
+    {
+        return pb.get() != 0;
+    }
+
+    // conversions to shared_ptr; the observers keep seeing the object
+    // until the last shared_ptr goes away. If the shared_ptr can not
+    // allocate its count, the object is destroyed as with shared_ptr( p, d ).
+
+    operator boost::shared_ptr<T>() &&
+    {
+        return to_shared< boost::shared_ptr<T> >();
+    }
+
+    operator std::shared_ptr<T>() &&
+    {
+        return to_shared< std::shared_ptr<T> >();
+    }
+
+    // swap
+
+    // the bases are swapped whole, as empty_value::get() is not constexpr
+    BOOST_WUP_CXX20_CONSTEXPR void swap( weakable_unique_ptr & r ) noexcept
+    {
+        boost::detail::wup_swap( static_cast<boost::empty_value<Deleter>&>( *this ), static_cast<boost::empty_value<Deleter>&>( r ) );
+        boost::detail::wup_swap( static_cast<extent_type&>( *this ), static_cast<extent_type&>( r ) );
+        pb.swap( r.pb );
+    }
+};
+
+static_assert( sizeof( weakable_unique_ptr<int> ) == 2 * sizeof( void* ),
+    "weakable_unique_ptr with a stateless deleter must take two pointers" );
+
+static_assert( sizeof( weakable_unique_ptr<int, std::default_delete<int>, weakable_compact<>> ) == sizeof( void* ),
+    "compact weakable_unique_ptr with a stateless deleter must take one pointer" );
+
+// A moved from owner holds nothing but its moved from deleter, so
+// containers such as boost::container::vector need not destroy it.
+template<class T, class D, class P>
+struct has_trivial_destructor_after_move< weakable_unique_ptr<T, D, P> >
+    : has_trivial_destructor_after_move<D>
+{
+};
+
+// Keeps the object of a unique_weak_ptr alive, see unique_weak_ptr::lock().
+// With weakable_epoch the lock is bound to the thread that took it, and
+// can not be moved from C++17 on, where lock() does not need to.
+template<class T, class Policy = weakable_single_threaded>
+class unique_weak_lock
+{
+public:
+
+    typedef typename boost::detail::sp_element<T>::type element_type;
+
+private:
+
+    typedef boost::detail::weakable_unique_ptr_control_block<Policy> control_block;
+
+    control_block * pc;
+    element_type * px;
+
+    friend class unique_weak_ptr<T, Policy>;
+
+    // pc is kept only when pin() succeeded and the state has to be told
+    // when the lock goes; px of an alias may be null
+    unique_weak_lock( control_block * pc_, element_type * p ) noexcept
+        : pc( 0 ), px( 0 )
+    {
+        if( pc_ && pc_->pin() )
+        {
+            pc = Policy::state::pinning::value? pc_: nullptr;
+            px = p;
+        }
+    }
+
+public:
+
+    ~unique_weak_lock() noexcept
+    {
+        if( pc )
+        {
+            pc->unpin();
+        }
+    }
+
+    constexpr unique_weak_lock() noexcept : pc( 0 ), px( 0 )
+    {
+    }
+
+    unique_weak_lock( unique_weak_lock&& r ) noexcept : pc( r.pc ), px( r.px )
+    {
+#if defined( __cpp_guaranteed_copy_elision )
+        static_assert( !Policy::state::thread_bound_pin::value,
+            "A lock of weakable_epoch is bound to the thread that took it" );
+#endif
+
+        r.pc = 0;
+        r.px = 0;
+    }
+
+    unique_weak_lock( const unique_weak_lock& r ) = delete;
+
+    unique_weak_lock& operator=( unique_weak_lock&& r ) noexcept
+    {
+        unique_weak_lock( std::move( r ) ).swap( *this );
+        return *this;
+    }
+
+    unique_weak_lock& operator=( const unique_weak_lock& r ) = delete;
+
+    void swap( unique_weak_lock& r ) noexcept
+    {
+        static_assert( !Policy::state::thread_bound_pin::value,
+            "A lock of weakable_epoch is bound to the thread that took it" );
+
+        std::swap( pc, r.pc );
+        std::swap( px, r.px );
+    }
+
+    typename boost::detail::sp_dereference< T >::type operator* () const noexcept
+    {
+        return *px;
+    }
+
+    typename boost::detail::sp_member_access< T >::type operator-> () const noexcept
+    {
+        return px;
+    }
+
+    typename boost::detail::sp_array_access< T >::type operator[] ( std::ptrdiff_t i ) const noexcept
+    {
+        return px[ i ];
+    }
+
+    element_type * get() const noexcept
+    {
+        return px;
+    }
+
+    explicit operator bool () const noexcept
+    {
+        return px != 0;
+    }
+};
+
+// The object of a unique_weak_ptr for one borrower at a time, see
+// unique_weak_ptr::try_borrow().
+template<class T, class Policy = weakable_single_threaded>
+class unique_weak_borrow
+{
+public:
+
+    typedef typename boost::detail::sp_element<T>::type element_type;
+
+private:
+
+    typedef boost::detail::weakable_unique_ptr_control_block<Policy> control_block;
+
+    control_block * pc;
+    element_type * px;
+
+    friend class unique_weak_ptr<T, Policy>;
+
+    // pc is kept only when borrow() succeeded, px of an alias may be null
+    unique_weak_borrow( control_block * pc_, element_type * p ) noexcept
+        : pc( pc_ && pc_->borrow() ? pc_ : nullptr ), px( pc ? p : nullptr )
+    {
+    }
+
+public:
+
+    ~unique_weak_borrow() noexcept
+    {
+        if( pc )
+        {
+            pc->unborrow();
+        }
+    }
+
+    constexpr unique_weak_borrow() noexcept : pc( 0 ), px( 0 )
+    {
+    }
+
+    unique_weak_borrow( unique_weak_borrow&& r ) noexcept : pc( r.pc ), px( r.px )
+    {
+        r.pc = 0;
+        r.px = 0;
+    }
+
+    unique_weak_borrow( const unique_weak_borrow& r ) = delete;
+
+    unique_weak_borrow& operator=( unique_weak_borrow&& r ) noexcept
+    {
+        unique_weak_borrow( std::move( r ) ).swap( *this );
+        return *this;
+    }
+
+    unique_weak_borrow& operator=( const unique_weak_borrow& r ) = delete;
+
+    void swap( unique_weak_borrow& r ) noexcept
+    {
+        std::swap( pc, r.pc );
+        std::swap( px, r.px );
+    }
+
+    typename boost::detail::sp_dereference< T >::type operator* () const noexcept
+    {
+        return *px;
+    }
+
+    typename boost::detail::sp_member_access< T >::type operator-> () const noexcept
+    {
+        return px;
+    }
+
+    typename boost::detail::sp_array_access< T >::type operator[] ( std::ptrdiff_t i ) const noexcept
+    {
+        return px[ i ];
+    }
+
+    element_type * get() const noexcept
+    {
+        return px;
+    }
+
+    explicit operator bool () const noexcept
+    {
+        return px != 0;
+    }
+};
+
+template<class T, class Policy>
+class BOOST_WUP_RELOCATABLE_IF( true ) unique_weak_ptr BOOST_WUP_RELOCATABLE_IF_ELIGIBLE
+    : boost::detail::wup_extent<T> // the length of an array
+{
+public:
+
+    typedef typename boost::detail::sp_element<T>::type element_type;
+    typedef Policy policy_type;
+
+private:
+
+    typedef boost::detail::weakable_unique_ptr_control_block<Policy> control_block;
+    typedef boost::detail::wup_extent<T> extent_type;
+
+    // px is only meaningful while the block says the object is alive;
+    // two words, the same as weak_ptr. pc holds one reference, counted by
+    // hand so that moves and assignments do not touch the count more than
+    // they must.
+    element_type * px;
+    control_block * pc;
+
+    template<class Y, class P> friend class unique_weak_ptr;
+    template<class Y, class P> friend class weak_observer_list;
+    template<class P> friend class weak_expiry_hook;
+    template<class K, class V, class P> friend class weak_key_map;
+
+    constexpr const extent_type& extent() const noexcept
+    {
+        return *this;
+    }
+
+    static BOOST_CXX14_CONSTEXPR control_block * add_ref( control_block * c ) noexcept
+    {
+        if( c )
+        {
+            intrusive_ptr_add_ref( c );
+        }
+        return c;
+    }
+
+    // takes the pointers, and the reference of c; drops the old reference
+    BOOST_CXX14_CONSTEXPR void assign( const extent_type& e, element_type * p, control_block * c ) noexcept
+    {
+        control_block * old = pc;
+
+        static_cast<extent_type&>( *this ) = e;
+        px = p;
+        pc = c;
+
+        if( old )
+        {
+            intrusive_ptr_release( old );
+        }
+    }
+
+public:
+    BOOST_WUP_CXX20_CONSTEXPR ~unique_weak_ptr()
+    {
+        if( pc )
+        {
+            intrusive_ptr_release( pc );
+        }
+    }
+
+    constexpr unique_weak_ptr() noexcept : px( 0 ), pc( 0 )
+    {
+    }
+
+    BOOST_CXX14_CONSTEXPR unique_weak_ptr( const unique_weak_ptr& r ) noexcept: extent_type( r ), px( r.px ), pc( add_ref( r.pc ) )
+    {
+    }
+
+    // internal constructor, used by enable_weakable_from_this
+
+    BOOST_CXX14_CONSTEXPR unique_weak_ptr( boost::detail::wup_internal_constructor_tag, element_type * p,
+        boost::detail::weakable_unique_ptr_control_block<Policy> * pc_ ) noexcept
+        : px( p ), pc( add_ref( pc_ ) )
+    {
+    }
+
+    // the object is pinned while Y* is converted to T*,
+    // which may read it when T is a virtual base of Y
+    template<class Y>
+    unique_weak_ptr( const unique_weak_ptr<Y, Policy>& r,
+        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty() ) noexcept
+        : extent_type( r.extent().size() ), px( r.lock().get() ), pc( add_ref( r.pc ) )
+    {
+        boost::detail::sp_assert_convertible< Y, T >();
+    }
+
+    // creates the control block of r if it does not have one yet,
+    // see weakable_unique_ptr::pc for the thread safety rules
+    template<class Y, class E>
+    unique_weak_ptr( const weakable_unique_ptr<Y, E, Policy>& r,
+        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty() )
+        : extent_type( r.extent().size() ), px( r.get() ), pc( add_ref( r.get_control_block() ) )
+    {
+        boost::detail::sp_assert_convertible< Y, T >();
+    }
+
+    // Aliasing constructors: observe p, a member or an element of the
+    // object of r, through the control block of that object. p expires
+    // with it, and the identity of the observer is the one of r.
+
+    template<class Y>
+    BOOST_CXX14_CONSTEXPR unique_weak_ptr( const unique_weak_ptr<Y, Policy>& r, element_type * p ) noexcept
+        : px( p ), pc( add_ref( r.pc ) )
+    {
+        static_assert( !std::is_array<T>::value, "An aliasing unique_weak_ptr observes a single object" );
+    }
+
+    template<class Y>
+    BOOST_CXX14_CONSTEXPR unique_weak_ptr( unique_weak_ptr<Y, Policy>&& r, element_type * p ) noexcept
+        : px( p ), pc( r.pc )
+    {
+        static_assert( !std::is_array<T>::value, "An aliasing unique_weak_ptr observes a single object" );
+        r.px = 0;
+        r.pc = 0;
+    }
+
+    template<class Y, class E>
+    unique_weak_ptr( const weakable_unique_ptr<Y, E, Policy>& r, element_type * p )
+        : px( p ), pc( add_ref( r.get_control_block() ) )
+    {
+        static_assert( !std::is_array<T>::value, "An aliasing unique_weak_ptr observes a single object" );
+    }
+
+    BOOST_CXX14_CONSTEXPR unique_weak_ptr( unique_weak_ptr&& r ) noexcept : extent_type( r ), px( r.px ), pc( r.pc )
+    {
+        r.px = 0;
+        r.pc = 0;
+    }
+
+    template<class Y>
+    unique_weak_ptr( unique_weak_ptr<Y, Policy>&& r,
+        typename boost::detail::sp_enable_if_convertible<Y, T>::type = boost::detail::sp_empty() ) noexcept
+        : extent_type( r.extent().size() ), px( r.lock().get() ), pc( r.pc )
+    {
+        boost::detail::sp_assert_convertible< Y, T >();
+        r.px = 0;
+        r.pc = 0;
+    }
+
+    // the new reference is taken before the old one is dropped,
+    // which makes self assignment safe
+
+    BOOST_CXX14_CONSTEXPR unique_weak_ptr& operator=( const unique_weak_ptr& r ) noexcept
+    {
+        assign( r, r.px, add_ref( r.pc ) );
+        return *this;
+    }
+
+    template<class Y>
+    unique_weak_ptr& operator=( const unique_weak_ptr<Y, Policy>& r ) noexcept
+    {
+        element_type * p = r.lock().get();
+        assign( extent_type( r.extent().size() ), p, add_ref( r.pc ) );
+        return *this;
+    }
+
+    template<class Y, class E>
+    unique_weak_ptr& operator=( const weakable_unique_ptr<Y, E, Policy>& r )
+    {
+        control_block * c = add_ref( r.get_control_block() );
+        assign( extent_type( r.extent().size() ), r.get(), c );
+        return *this;
+    }
+
+    BOOST_CXX14_CONSTEXPR unique_weak_ptr& operator=( unique_weak_ptr&& r ) noexcept
+    {
+        element_type * p = r.px;
+        control_block * c = r.pc;
+
+        r.px = 0;
+        r.pc = 0;
+
+        assign( r, p, c );
+        return *this;
+    }
+
+    template<class Y>
+    unique_weak_ptr& operator=( unique_weak_ptr<Y, Policy>&& r ) noexcept
+    {
+        element_type * p = r.lock().get();
+        control_block * c = r.pc;
+
+        r.px = 0;
+        r.pc = 0;
+
+        assign( extent_type( r.extent().size() ), p, c );
+        return *this;
+    }
+
+    BOOST_CXX14_CONSTEXPR void reset() noexcept
+    {
+        assign( extent_type(), 0, 0 );
+    }
+
+    BOOST_CXX14_CONSTEXPR void swap( unique_weak_ptr& r ) noexcept
+    {
+        boost::detail::wup_swap( static_cast<extent_type&>( *this ), static_cast<extent_type&>( r ) );
+        boost::detail::wup_swap( px, r.px );
+        boost::detail::wup_swap( pc, r.pc );
+    }
+
+    constexpr bool expired() const noexcept
+    {
+        return !( pc && pc->get() );
+    }
+
+    // with weakable_multi_threaded the owner may destroy the object
+    // right after this returns, use lock() to keep it alive; with
+    // weakable_epoch the object lives as long as a weakable_epoch_guard;
+    // a weakable_span for an array
+    constexpr typename extent_type::view_type try_get() const noexcept
+    {
+        return this->view( pc && pc->peek() ? px : nullptr );
+    }
+
+    // Pins the object until the returned lock is destroyed; the lock is
+    // empty if the object has already expired. The owner of a pinned object
+    // waits in its destructor for the lock to go away, so the thread holding
+    // a lock must not destroy the owner.
+    unique_weak_lock<T, Policy> lock() const noexcept
+    {
+        return unique_weak_lock<T, Policy>( pc, px );
+    }
+
+    // As lock(), for one borrower at a time: the borrow is empty if the
+    // object has expired or another borrow of it is alive. Readers that
+    // hold a lock() are not kept out, nor is the owner. Only the policies
+    // whose owner waits for the borrower have it, which with
+    // BOOST_SP_DISABLE_THREADS the multi-threaded ones do not.
+    unique_weak_borrow<T, Policy> try_borrow() const noexcept
+    {
+        static_assert( Policy::state::borrowing::value,
+            "try_borrow() needs a thread-safe policy, whose owner waits for the borrower" );
+
+        return unique_weak_borrow<T, Policy>( pc, px );
+    }
+
+    // The identity of the object is its control block, which stays in
+    // place for as long as somebody observes the object, expired or not.
+
+    template<class Y>
+    BOOST_CXX14_CONSTEXPR bool owner_before( const unique_weak_ptr<Y, Policy>& r ) const noexcept
+    {
+        return std::less<control_block*>()( pc, r.pc );
+    }
+
+    template<class Y>
+    constexpr bool owner_equals( const unique_weak_ptr<Y, Policy>& r ) const noexcept
+    {
+        return pc == r.pc;
+    }
+
+    std::size_t owner_hash_value() const noexcept
+    {
+        return std::hash<control_block*>()( pc );
+    }
+
+    // the same object seen through the same pointer
+    template<class Y>
+    constexpr bool operator==( const unique_weak_ptr<Y, Policy>& r ) const noexcept
+    {
+        return pc == r.pc && px == r.px;
+    }
+
+    template<class Y>
+    constexpr bool operator!=( const unique_weak_ptr<Y, Policy>& r ) const noexcept
+    {
+        return !( *this == r );
+    }
+};
+
+template<class T, class P>
+struct has_trivial_destructor_after_move< unique_weak_ptr<T, P> >
+    : std::true_type
+{
+};
+
+// Base of the objects that are told when an observed object expires, for
+// example to drop a cache entry right away instead of sweeping for
+// expired ones. The hook is linked into the control block of the object,
+// which keeps a list of hooks with weakable_hooked, and on_expire() is
+// called once, by whatever expires the observers, usually the destructor
+// of the owner. With weakable_multi_threaded it may run on the thread of
+// the owner before hook() returns, and a hook must not be destroyed by
+// another thread while its on_expire() runs.
+template<class Policy = weakable_hooked<>>
+class weak_expiry_hook
+    : boost::detail::wup_hook_node
+{
+    static_assert( Policy::state::expiry_hooks::value,
+        "The control blocks of the policy keep no hooks; use weakable_hooked<Policy>" );
+
+    typedef boost::detail::weakable_unique_ptr_control_block<Policy> control_block;
+
+    intrusive_ptr<control_block> pc;
+
+protected:
+
+    weak_expiry_hook() noexcept
+    {
+    }
+
+    // a copy is not hooked
+    weak_expiry_hook( const weak_expiry_hook& ) noexcept : boost::detail::wup_hook_node()
+    {
+    }
+
+    weak_expiry_hook& operator=( const weak_expiry_hook& ) noexcept
+    {
+        return *this;
+    }
+
+    ~weak_expiry_hook() noexcept
+    {
+        unhook();
+    }
+
+public:
+
+    // hooks into the block of w, after unhooking from the previous one;
+    // false if w has already expired
+    template<class T>
+    bool hook( const unique_weak_ptr<T, Policy>& w ) noexcept
+    {
+        unhook();
+
+        if( !w.pc )
+        {
+            return false;
+        }
+
+        pc = w.pc;
+
+        if( !pc->hook( this ) )
+        {
+            pc.reset();
+            return false;
+        }
+
+        return true;
+    }
+
+    void unhook() noexcept
+    {
+        if( pc )
+        {
+            pc->unhook( this );
+            pc.reset();
+        }
+    }
+
+    virtual void on_expire() noexcept = 0;
+};
+
+// make_weakable_unique, allocate_weakable_unique
+//
+// make_weakable_unique allocates with the allocator of the policy: with
+// weakable_pooled the object and its control block take one slot of a
+// thread local size class, which stays, with the object destroyed, until
+// the last observer goes away.
+
+template<class T, class Policy = weakable_single_threaded, class A, class... Args>
+inline typename std::enable_if<!std::is_array<T>::value, weakable_unique_ptr<T, weakable_inplace_deleter, Policy>>::type
+    allocate_weakable_unique( const A& a, Args&&... args )
+{
+    typedef boost::detail::weakable_unique_ptr_inplace_block<T, A, Policy> block;
+
+    block * pb = block::create( a, std::forward<Args>( args )... );
+    return weakable_unique_ptr<T, weakable_inplace_deleter, Policy>( boost::detail::wup_internal_constructor_tag(), pb->object(), pb );
+}
+
+template<class T, class Policy = weakable_single_threaded, class... Args>
+inline typename std::enable_if<!std::is_array<T>::value, weakable_unique_ptr<T, weakable_inplace_deleter, Policy>>::type
+    make_weakable_unique( Args&&... args )
+{
+    typedef typename boost::allocator_rebind<typename Policy::allocator_type, T>::type allocator_type;
+    return boost::allocate_weakable_unique<T, Policy>( allocator_type(), std::forward<Args>( args )... );
+}
+
+// n value initialized elements after the control block
+
+template<class T, class Policy = weakable_single_threaded, class A>
+inline typename std::enable_if<std::is_array<T>::value && std::extent<T>::value == 0, weakable_unique_ptr<T, weakable_inplace_deleter, Policy>>::type
+    allocate_weakable_unique( const A& a, std::size_t n )
+{
+    typedef boost::detail::weakable_unique_ptr_inplace_array_block<typename std::remove_extent<T>::type, A, Policy> block;
+
+    block * pb = block::create( a, n );
+    return weakable_unique_ptr<T, weakable_inplace_deleter, Policy>( boost::detail::wup_internal_constructor_tag(), pb->object(), pb, n );
+}
+
+template<class T, class Policy = weakable_single_threaded>
+inline typename std::enable_if<std::is_array<T>::value && std::extent<T>::value == 0, weakable_unique_ptr<T, weakable_inplace_deleter, Policy>>::type
+    make_weakable_unique( std::size_t n )
+{
+    typedef typename boost::allocator_rebind<typename Policy::allocator_type, typename std::remove_extent<T>::type>::type allocator_type;
+    return boost::allocate_weakable_unique<T, Policy>( allocator_type(), n );
+}
+
+namespace detail {
+
+// whether the owners of a policy keep their objects behind control blocks,
+// which weakable_destroy_all prefetches; see weakable_handle_table.hpp
+template<class P>
+struct wup_has_blocks: std::true_type
+{
+};
+
+template<class It>
+void wup_destroy_all( It first, It last, std::true_type ) noexcept
+{
+    typedef typename std::iterator_traits<It>::value_type owner;
+
+    It ahead = first;
+
+    for( std::size_t i = 0; i < owner::destroy_distance && ahead != last; ++i, ++ahead )
+    {
+        ahead->prefetch();
+    }
+
+    for( ; first != last; ++first )
+    {
+        if( ahead != last )
+        {
+            ahead->prefetch();
+            ++ahead;
+        }
+
+        first->reset();
+    }
+}
+
+// rejected by the static_assert of weakable_destroy_all
+template<class It>
+void wup_destroy_all( It, It, std::false_type ) noexcept
+{
+}
+}
+
+// Destroys the objects of a range of owners and leaves the owners empty,
+// as a reset() of each would, with the objects and the blocks of the next
+// owners prefetched while one is reset. A deleter may not touch the owners
+// of the range that come after its own.
+template<class It>
+void weakable_destroy_all( It first, It last ) noexcept
+{
+    typedef boost::detail::wup_has_blocks<typename std::iterator_traits<It>::value_type::policy_type> has_blocks;
+
+    static_assert( std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>::value,
+        "weakable_destroy_all walks the range twice, a few owners apart" );
+
+    static_assert( has_blocks::value,
+        "weakable_destroy_all does not take weakable_generational owners, whose objects live in a slot table and not behind blocks; reset() them in a loop" );
+
+    boost::detail::wup_destroy_all( first, last, has_blocks() );
+}
+
+template<class R>
+void weakable_destroy_all( R& r ) noexcept
+{
+    using std::begin;
+    using std::end;
+
+    boost::weakable_destroy_all( begin( r ), end( r ) );
+}
+}
+
+namespace std {
+
+// hashes the identity of the object, see unique_weak_ptr::owner_hash_value()
+template<class T, class Policy>
+struct hash< ::boost::unique_weak_ptr<T, Policy> >
+{
+    std::size_t operator()( const ::boost::unique_weak_ptr<T, Policy>& p ) const noexcept
     {
-        return pc ? pc->get() : nullptr;
+        return p.owner_hash_value();
     }
 };
 }